@@ -0,0 +1,79 @@
+#include "VaroniaJournal.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVaroniaJournalRoundTripTest, "Varonia.Journal.RoundTrip",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FVaroniaJournalRoundTripTest::RunTest(const FString& Parameters)
+{
+    FVaroniaJournal& Journal = FVaroniaJournal::Get();
+
+    // The journal is a singleton: borrow it with a scratch directory, then put it back
+    const bool bWasRunning = Journal.IsRunning();
+    const FString PreviousDirectory = Journal.GetDirectory();
+    Journal.Stop();
+
+    const FString Directory = FPaths::AutomationTransientDir() / TEXT("VaroniaJournal");
+    IFileManager::Get().DeleteDirectory(*Directory, false, true);
+    IFileManager::Get().MakeDirectory(*Directory, true);
+
+    constexpr int64 Marker = 0x7E57;
+    constexpr int32 Count = 100;
+
+    Journal.Start(Directory);
+    TestTrue(TEXT("Journal started"), Journal.IsRunning());
+    for (int32 i = 0; i < Count; ++i)
+    {
+        Journal.Record(EVaroniaJournalEvent::ConfigPatched, Marker, i);
+    }
+    Journal.Record(EVaroniaJournalEvent::BoundaryEntered, 42, 3);
+
+    // Stop drains every ring into the file
+    Journal.Stop();
+
+    FDateTime Start;
+    TArray<FVaroniaJournalRecord> Records;
+    if (TestTrue(TEXT("ReadFile"), FVaroniaJournal::ReadFile(Directory / TEXT("Journal.vjl"), Start, Records)))
+    {
+        TestTrue(TEXT("Start time is recent"), (FDateTime::UtcNow() - Start).GetTotalMinutes() < 5.0);
+        TestTrue(TEXT("First record is JournalStarted"),
+            Records.Num() > 0 && Records[0].Event == (uint16)EVaroniaJournalEvent::JournalStarted);
+
+        // Other threads may have recorded meanwhile: check ours, in order
+        int32 Next = 0;
+        bool bBoundary = false;
+        uint64 LastTime = 0;
+        for (const FVaroniaJournalRecord& Record : Records)
+        {
+            TestTrue(TEXT("Records are in time order"), Record.TimeUs >= LastTime);
+            LastTime = Record.TimeUs;
+
+            if (Record.Event == (uint16)EVaroniaJournalEvent::ConfigPatched && Record.A == Marker)
+            {
+                TestEqual(TEXT("Record order"), Record.B, (int64)Next);
+                TestEqual(TEXT("Recording thread"), Record.ThreadId, FPlatformTLS::GetCurrentThreadId());
+                ++Next;
+            }
+            else if (Record.Event == (uint16)EVaroniaJournalEvent::BoundaryEntered && Record.A == 42)
+            {
+                TestEqual(TEXT("Describe"), FVaroniaJournal::Describe(Record), FString(TEXT("Device 42 entered boundary 3")));
+                bBoundary = true;
+            }
+        }
+        TestEqual(TEXT("All records decoded"), Next, Count);
+        TestTrue(TEXT("Last record decoded"), bBoundary);
+    }
+
+    IFileManager::Get().DeleteDirectory(*Directory, false, true);
+    if (bWasRunning)
+    {
+        Journal.Start(PreviousDirectory);
+    }
+    return true;
+}
+
+#endif
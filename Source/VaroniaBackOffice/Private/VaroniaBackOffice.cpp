@@ -1,6 +1,9 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "VaroniaBackOffice.h"
+#include "VaroniaJournal.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
 //#include "OrthoCapture.h"
 
 #define LOCTEXT_NAMESPACE "FVaroniaBackOfficeModule"
@@ -8,11 +11,18 @@
 void FVaroniaBackOfficeModule::StartupModule()
 {
 	//FOrthoCaptureModeModule::Register();
+
+	if (!FParse::Param(FCommandLine::Get(), TEXT("NoVaroniaJournal")))
+	{
+		FVaroniaJournal::Get().Start(FPaths::ProjectLogDir() / TEXT("Varonia"));
+	}
 }
 
 void FVaroniaBackOfficeModule::ShutdownModule()
 {
 	//FOrthoCaptureModeModule::Unregister();
+
+	FVaroniaJournal::Get().Stop();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -7,10 +7,24 @@
 #include "HAL/PlatformFileManager.h"
 #include "Engine/Engine.h"
 #include "Engine/World.h"
+#include "Misc/App.h"
+#include "Engine/AssetManager.h"
+#include "VaroniaMqttLibrary.h"
+#include "VaroniaConfigPatch.h"
+#include "HAL/FileManager.h"
+#include "VaroniaInitGraph.h"
+#include "VaroniaTrace.h"
+#include "VaroniaStats.h"
+#include "VaroniaJournal.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 // Define the log category
 DEFINE_LOG_CATEGORY(LogVaronia);
 
+static const FString DeviceStatusChannel = TEXT("DeviceStatus");
+static const TCHAR* VaroniaBPPath = TEXT("/VaroniaBackOffice/BP_Varonia.BP_Varonia_C");
+
 // ============================================================================
 // Coordinate conversion: Unity ? Unreal
 // ============================================================================
@@ -37,10 +51,133 @@ FRotator UVaroniaBackOfficeManager::UnityQuatToUnrealRotator(float X, float Y, f
 void UVaroniaBackOfficeManager::Initialize(FSubsystemCollectionBase& Collection)
 {
     Super::Initialize(Collection);
-    LoadLBEConfig();
-    LoadSpatialConfig();
+
+    TrackedPoses = MakeUnique<TVaroniaTripleBuffer<FVaroniaTrackedPose>[]>(MaxTrackedDevices);
+    TrackedDeviceIDs = MakeUnique<std::atomic<int32>[]>(MaxTrackedDevices);
+    for (int32 Slot = 0; Slot < MaxTrackedDevices; ++Slot)
+    {
+        TrackedDeviceIDs[Slot].store(INDEX_NONE, std::memory_order_relaxed);
+    }
+
+    FVaroniaStartupTrace::Get().BeginCollecting();
+    StartupTraceDeadline = FPlatformTime::Seconds() + 30.0;
+
+    SoftStateMachine = FVaroniaSoftStateMachine(CurrentSoftState, FPlatformTime::Seconds());
+
+    // Config and spatial files are independent disk reads + parses; the broker only needs the config
+    FVaroniaInitGraph InitGraph;
+    InitGraph.AddStep(TEXT("Init.ConfigRead"), {}, EVaroniaInitThread::Worker, [this]() { LoadLBEConfig(); });
+    InitGraph.AddStep(TEXT("Init.SpatialParse"), {}, EVaroniaInitThread::Worker, [this]() { LoadSpatialConfig(); });
+    InitGraph.AddStep(TEXT("Init.ClassPreload"), {}, EVaroniaInitThread::GameThread, [this]() { RequestVaroniaClass(); });
+    InitGraph.AddStep(TEXT("Init.BrokerConnect"), { TEXT("Init.ConfigRead") }, EVaroniaInitThread::GameThread, [this]() { CreateMqttHandler(); });
+    InitGraph.Run();
+    InitGraph.LogReport();
+
+    Scheduler.BudgetUs = FrameBudgetUs;
+    Scheduler.AddTask(TEXT("Varonia.Replication"), EVaroniaTaskPriority::High, 50.f, [this](double)
+    {
+        if (MqttHandler)
+        {
+            MqttHandler->TickReplication(FPlatformTime::Seconds());
+        }
+        return true;
+    });
+    Scheduler.AddTask(TEXT("Varonia.Fleet"), EVaroniaTaskPriority::Normal, 100.f, [this](double)
+    {
+        if (IsServer())
+        {
+            Fleet.UpdateHealth(FPlatformTime::Seconds());
+            if (Fleet.ConsumeChanges(FleetChanges))
+            {
+                for (int32 DeviceID : FleetChanges)
+                {
+                    FVaroniaFleetEntry Entry;
+                    EVaroniaDeviceHealth& Journaled = JournaledHealth.FindOrAdd(DeviceID, EVaroniaDeviceHealth::Offline);
+                    if (Fleet.GetEntry(DeviceID, Entry) && Entry.Health != Journaled)
+                    {
+                        Journaled = Entry.Health;
+                        VARONIA_JOURNAL(DeviceHealthChanged, DeviceID, (int64)Entry.Health);
+                    }
+                }
+                OnFleetChanged.Broadcast(FleetChanges);
+            }
+        }
+        return true;
+    });
 
     FWorldDelegates::OnPostWorldInitialization.AddUObject(this, &UVaroniaBackOfficeManager::OnWorldCreated);
+    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UVaroniaBackOfficeManager::Tick));
+}
+
+// ============================================================================
+// Tick
+// ============================================================================
+
+bool UVaroniaBackOfficeManager::Tick(float DeltaTime)
+{
+    VARONIA_SCOPE_STAT(ManagerTick);
+
+    const double Now = FPlatformTime::Seconds();
+
+    LatchTrackedPoses();
+    DispatchBoundaryCrossings();
+
+    if (PendingVaroniaSpawns.Num() > 0 && !VaroniaClass && Now >= PendingVaroniaSpawns[0].Deadline)
+    {
+        UE_LOG(LogVaronia, Error, TEXT("BP_Varonia still not loaded after %.1f s, spawn skipped"), VaroniaClassLoadTimeout);
+        VARONIA_JOURNAL(SpawnTimedOut, (int64)(VaroniaClassLoadTimeout * 1000.f));
+        FailPendingVaroniaSpawns();
+    }
+
+    // Startup is over once BP_Varonia is up and the broker answered (or we stop waiting)
+    if (FVaroniaStartupTrace::Get().IsCollecting()
+        && ((Varonia_BP && MqttHandler && MqttHandler->IsConnected()) || Now >= StartupTraceDeadline))
+    {
+        FVaroniaStartupTrace::Get().Finish();
+    }
+
+    // Exchanges against two machines' clocks can't share one fit: start over when the time server changes
+    const int32 ElectedTimeServer = ElectTimeServer();
+    if (ElectedTimeServer != ClockServerID)
+    {
+        UE_LOG(LogVaronia, Log, TEXT("Time server: device %d (was %d)"), ElectedTimeServer, ClockServerID);
+        ClockServerID = ElectedTimeServer;
+        ClockSync.Reset();
+        NextTimeRequest = Now;
+    }
+
+    if (MqttHandler && MqttHandler->IsConnected())
+    {
+        if (ClockServerID != INDEX_NONE && !IsTimeServer() && Now >= NextTimeRequest)
+        {
+            SendTimeRequest();
+            NextTimeRequest = Now + ClockSync.GetRequestInterval();
+        }
+
+        if (Now >= NextHeartbeat)
+        {
+            SendHeartbeat();
+            NextHeartbeat = Now + 1.0;
+        }
+    }
+
+    if (PendingConfigWrites.Num() > 0 && Now >= ConfigWriteTime)
+    {
+        FlushConfigWrites();
+    }
+
+    if (Heatmap.IsValid() && HeatmapDecayFactor < 1.f && Now >= NextHeatmapDecay)
+    {
+        if (NextHeatmapDecay > 0.0)
+        {
+            Heatmap.Decay(HeatmapDecayFactor);
+        }
+        NextHeatmapDecay = Now + HeatmapDecayInterval;
+    }
+
+    Scheduler.Run();
+
+    return true;
 }
 
 // ============================================================================
@@ -53,46 +190,159 @@ void UVaroniaBackOfficeManager::OnWorldCreated(UWorld* World, const UWorld::Init
 
     if (!World || !World->IsGameWorld()) return;
 
-    FString BPPath = TEXT("/VaroniaBackOffice/BP_Varonia.BP_Varonia_C");
-    UClass* Varonia = StaticLoadClass(AActor::StaticClass(), nullptr, *BPPath);
+    if (!MqttHandler)
+    {
+        CreateMqttHandler();
+    }
 
 
-    if (!MqttHandler)
+    if (VaroniaClass)
     {
-        MqttHandler = NewObject<UVaroniaMqttClient>(this);
-        MqttHandler->Connect(CurrentConfig.MQTT_ServerIP, 1883, CurrentConfig.MQTT_IDClient);
-    
+        SpawnVaroniaBP(World);
     }
+    else
+    {
+        // Class still streaming in: spawn from OnVaroniaClassLoaded, or give up at the deadline
+        FPendingVaroniaSpawn& Pending = PendingVaroniaSpawns.AddDefaulted_GetRef();
+        Pending.World = World;
+        Pending.Deadline = FPlatformTime::Seconds() + VaroniaClassLoadTimeout;
+    }
+}
+
+// ============================================================================
+// MQTT
+// ============================================================================
+
+void UVaroniaBackOfficeManager::CreateMqttHandler()
+{
+    VARONIA_TRACE_SCOPE("Manager.CreateMqttHandler");
 
+    MqttHandler = NewObject<UVaroniaMqttClient>(this);
+    MqttHandler->OnMessageNative.AddUObject(this, &UVaroniaBackOfficeManager::HandleMqttMessage);
+    MqttHandler->OnConnected.AddDynamic(this, &UVaroniaBackOfficeManager::HandleMqttConnected);
 
-    if (Varonia)
+    if (IsSpectator())
     {
-        FActorSpawnParameters SpawnParams;
-        SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-        Varonia_BP = World->SpawnActor<AActor>(Varonia, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+        MqttHandler->Subscribe(FString::Printf(TEXT("%s/+"), VaroniaMqttTopics::Pose));
+    }
 
-#if WITH_EDITOR
-        if (Varonia_BP)
+    MqttHandler->Subscribe(FString::Printf(TEXT("%s/%d"), VaroniaMqttTopics::Config, CurrentConfig.MQTT_IDClient), 1);
+    MqttHandler->Subscribe(FString::Printf(TEXT("%s/All"), VaroniaMqttTopics::Config), 1);
+
+    MqttHandler->RegisterReplicatedStruct(DeviceStatusChannel, FVaroniaDeviceStatus::StaticStruct(), 4.f);
+
+    if (IsServer())
+    {
+        MqttHandler->MirrorReplicatedStruct(DeviceStatusChannel, FVaroniaDeviceStatus::StaticStruct());
+        MqttHandler->Subscribe(VaroniaMqttTopics::TimeRequest);
+        MqttHandler->Subscribe(FString::Printf(TEXT("%s/+"), VaroniaMqttTopics::Status));
+    }
+
+    // Servers too: only one of them is the time server, the others sync to it
+    MqttHandler->Subscribe(VaroniaMqttTopics::TimeServer);
+    MqttHandler->Subscribe(FString::Printf(TEXT("%s/%d"), VaroniaMqttTopics::TimeReply, CurrentConfig.MQTT_IDClient));
+
+    MqttHandler->Connect(CurrentConfig.MQTT_ServerIP, 1883, CurrentConfig.MQTT_IDClient);
+}
+
+// ============================================================================
+// BP_Varonia async preload
+// ============================================================================
+
+void UVaroniaBackOfficeManager::RequestVaroniaClass()
+{
+    VaroniaClassRequestTime = FPlatformTime::Seconds();
+    const FSoftObjectPath BPPath(VaroniaBPPath);
+
+    FStreamableManager& Streamable = UAssetManager::IsInitialized()
+        ? UAssetManager::GetStreamableManager()
+        : StandaloneStreamable;
+
+    VaroniaClassHandle = Streamable.RequestAsyncLoad(BPPath,
+        FStreamableDelegate::CreateUObject(this, &UVaroniaBackOfficeManager::OnVaroniaClassLoaded),
+        FStreamableManager::AsyncLoadHighPriority);
+
+    // Null only for an invalid path; an already resident class still completes through the delegate
+    if (!VaroniaClassHandle.IsValid())
+    {
+        UE_LOG(LogVaronia, Error, TEXT("Failed to request BP_Varonia at: %s"), VaroniaBPPath);
+    }
+}
+
+void UVaroniaBackOfficeManager::OnVaroniaClassLoaded()
+{
+    // Resolve by path: the delegate may run before RequestAsyncLoad has returned the handle
+    VaroniaClass = Cast<UClass>(FSoftObjectPath(VaroniaBPPath).ResolveObject());
+    FVaroniaStartupTrace::Get().AddSpan(TEXT("BP_Varonia.AsyncLoad"), VaroniaClassRequestTime, FPlatformTime::Seconds());
+
+    if (!VaroniaClass)
+    {
+        UE_LOG(LogVaronia, Error, TEXT("Failed to load BP_Varonia at: %s"), VaroniaBPPath);
+        FailPendingVaroniaSpawns();
+        return;
+    }
+
+    TArray<FPendingVaroniaSpawn> Pending = MoveTemp(PendingVaroniaSpawns);
+    for (const FPendingVaroniaSpawn& Spawn : Pending)
+    {
+        if (UWorld* World = Spawn.World.Get())
         {
-            Varonia_BP->SetActorLabel(TEXT("[Global Varonia]"));
+            SpawnVaroniaBP(World);
         }
-#endif
-
-        UE_LOG(LogVaronia, Log, TEXT("BP_Varonia spawned successfully"));
     }
-    else
+}
+
+void UVaroniaBackOfficeManager::FailPendingVaroniaSpawns()
+{
+    if (PendingVaroniaSpawns.Num() == 0) return;
+
+    PendingVaroniaSpawns.Reset();
+    OnVaroniaBPReady.Broadcast(nullptr);
+}
+
+void UVaroniaBackOfficeManager::SpawnVaroniaBP(UWorld* World)
+{
+    VARONIA_TRACE_SCOPE("BP_Varonia.Spawn");
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    Varonia_BP = World->SpawnActor<AActor>(VaroniaClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+
+#if WITH_EDITOR
+    if (Varonia_BP)
     {
-        UE_LOG(LogVaronia, Error, TEXT("Failed to load BP_Varonia at: %s"), *BPPath);
+        Varonia_BP->SetActorLabel(TEXT("[Global Varonia]"));
     }
+#endif
+
+    UE_LOG(LogVaronia, Log, TEXT("BP_Varonia spawned successfully"));
+    OnVaroniaBPReady.Broadcast(Varonia_BP);
 }
 
 
 void UVaroniaBackOfficeManager::Deinitialize()
 {
+    FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+    if (VaroniaClassHandle.IsValid())
+    {
+        VaroniaClassHandle->CancelHandle();
+        VaroniaClassHandle.Reset();
+    }
+
     if (MqttHandler)
     {
         MqttHandler->Disconnect();
     }
+
+    FlushConfigWrites();
+    ConfigWriteTask.Wait();
+
+    if (Heatmap.IsValid())
+    {
+        ExportHeatmap();
+    }
+
     Super::Deinitialize();
 }
 
@@ -130,25 +380,42 @@ FString UVaroniaBackOfficeManager::GetSpatialPath()
 
 bool UVaroniaBackOfficeManager::LoadLBEConfig()
 {
-    FString FilePath = GetConfigPath();
+    return LoadLBEConfigFromFile(GetConfigPath());
+}
+
+bool UVaroniaBackOfficeManager::LoadLBEConfigFromFile(const FString& FilePath)
+{
+    VARONIA_TRACE_SCOPE("Manager.LoadLBEConfig");
+    VARONIA_SCOPE_STAT(ConfigLoad);
+
     FString JsonString;
 
     UE_LOG(LogVaronia, Verbose, TEXT("Config path: %s"), *FilePath);
 
     if (FFileHelper::LoadFileToString(JsonString, *FilePath)) {
-        if (FJsonObjectConverter::JsonObjectStringToUStruct(JsonString, &CurrentConfig, 0, 0)) {
+        TSharedPtr<FJsonObject> Root;
+        TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+        if (FJsonSerializer::Deserialize(Reader, Root) && Root.IsValid()
+            && FJsonObjectConverter::JsonObjectToUStruct(Root.ToSharedRef(), &CurrentConfig, 0, 0)) {
+
+            // Versions of config-only patches; spatial patch versions come back with the spatial journal
+            int64 Version = 0;
+            if (Root->TryGetNumberField(TEXT("ConfigVersion"), Version)) { AppliedConfigVersion = FMath::Max(AppliedConfigVersion, Version); }
+            if (Root->TryGetNumberField(TEXT("ConfigVersionAll"), Version)) { AppliedConfigAllVersion = FMath::Max(AppliedConfigAllVersion, Version); }
 
             const UEnum* ModeEnum = StaticEnum<EDeviceMode>();
             const UEnum* HandEnum = StaticEnum<EMainHand>();
 
+            VARONIA_JOURNAL(ConfigLoaded, CurrentConfig.MQTT_IDClient, (int64)CurrentConfig.DeviceMode);
+
             UE_LOG(LogVaronia, Log, TEXT("Config loaded successfully"));
-            UE_LOG(LogVaronia, Log, TEXT("  PlayerName: %s"), *CurrentConfig.PlayerName);
-            UE_LOG(LogVaronia, Log, TEXT("  ServerIP: %s"), *CurrentConfig.ServerIP);
-            UE_LOG(LogVaronia, Log, TEXT("  MQTT_ServerIP: %s"), *CurrentConfig.MQTT_ServerIP);
-            UE_LOG(LogVaronia, Log, TEXT("  MQTT_IDClient: %d"), CurrentConfig.MQTT_IDClient);
-            UE_LOG(LogVaronia, Log, TEXT("  DeviceMode: %s"), *ModeEnum->GetNameStringByValue((int64)CurrentConfig.DeviceMode));
-            UE_LOG(LogVaronia, Log, TEXT("  MainHand: %s"), *HandEnum->GetNameStringByValue((int64)CurrentConfig.MainHand));
-            UE_LOG(LogVaronia, Log, TEXT("  Language: %s"), *CurrentConfig.Language);
+            UE_LOG(LogVaronia, Verbose, TEXT("  PlayerName: %s"), *CurrentConfig.PlayerName);
+            UE_LOG(LogVaronia, Verbose, TEXT("  ServerIP: %s"), *CurrentConfig.ServerIP);
+            UE_LOG(LogVaronia, Verbose, TEXT("  MQTT_ServerIP: %s"), *CurrentConfig.MQTT_ServerIP);
+            UE_LOG(LogVaronia, Verbose, TEXT("  MQTT_IDClient: %d"), CurrentConfig.MQTT_IDClient);
+            UE_LOG(LogVaronia, Verbose, TEXT("  DeviceMode: %s"), *ModeEnum->GetNameStringByValue((int64)CurrentConfig.DeviceMode));
+            UE_LOG(LogVaronia, Verbose, TEXT("  MainHand: %s"), *HandEnum->GetNameStringByValue((int64)CurrentConfig.MainHand));
+            UE_LOG(LogVaronia, Verbose, TEXT("  Language: %s"), *CurrentConfig.Language);
 
             return true;
         }
@@ -163,6 +430,7 @@ bool UVaroniaBackOfficeManager::LoadLBEConfig()
     }
 
     // Default config creation
+    VARONIA_JOURNAL(ConfigDefaulted);
     CurrentConfig = FLBEConfig();
     TSharedRef<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
     JsonObject->SetStringField(TEXT("ServerIP"), CurrentConfig.ServerIP);
@@ -190,7 +458,14 @@ bool UVaroniaBackOfficeManager::LoadLBEConfig()
 
 bool UVaroniaBackOfficeManager::LoadSpatialConfig()
 {
-    FString FilePath = GetSpatialPath();
+    return LoadSpatialConfigFromFile(GetSpatialPath());
+}
+
+bool UVaroniaBackOfficeManager::LoadSpatialConfigFromFile(const FString& FilePath)
+{
+    VARONIA_TRACE_SCOPE("Manager.LoadSpatialConfig");
+    VARONIA_SCOPE_STAT(SpatialParse);
+
     FString JsonString;
 
     UE_LOG(LogVaronia, Verbose, TEXT("Spatial path: %s"), *FilePath);
@@ -202,25 +477,100 @@ bool UVaroniaBackOfficeManager::LoadSpatialConfig()
         return false;
     }
 
+    if (!ParseSpatialConfig(JsonString, SpatialConfig))
+    {
+        UE_LOG(LogVaronia, Error, TEXT("Failed to parse NewSpatial.json"));
+        bSpatialConfigLoaded = false;
+        return false;
+    }
+
+    bSpatialConfigLoaded = true;
+    SpatialFilePath = FilePath;
+    VARONIA_JOURNAL(SpatialLoaded, SpatialConfig.Boundaries.Num());
+
+    // Back office patches received since this file was written
+    ReplaySpatialJournal(FilePath);
+
+    Heatmap.Init(SpatialConfig, HeatmapCellSize, HeatmapContactDistance);
+    Placement.Build(SpatialConfig, PlacementSpacing, PlacementClearance);
+    Crossings.Build(SpatialConfig, BoundaryHysteresis);
+
+#if STATS
+    SIZE_T SpatialBytes = SpatialConfig.Boundaries.GetAllocatedSize();
+    for (const FSpatialBoundary& Boundary : SpatialConfig.Boundaries)
+    {
+        SpatialBytes += Boundary.Points.GetAllocatedSize() + Boundary.ID.GetAllocatedSize();
+    }
+    SET_MEMORY_STAT(STAT_Varonia_SpatialMemory, SpatialBytes);
+#endif
+
+    UE_LOG(LogVaronia, Log, TEXT("Spatial loaded: %s (%s)  %d boundaries"),
+        *SpatialConfig.Name, *SpatialConfig.AreaValue, SpatialConfig.Boundaries.Num());
+    UE_LOG(LogVaronia, Verbose, TEXT("  SyncPos: %s"), *SpatialConfig.SyncPosition.ToString());
+    UE_LOG(LogVaronia, Verbose, TEXT("  SyncRot: %s"), *SpatialConfig.SyncRotation.ToString());
+
+    return true;
+}
+
+void UVaroniaBackOfficeManager::ParseSpatialBoundary(const TSharedPtr<FJsonObject>& BObj, FSpatialBoundary& Boundary)
+{
+    Boundary.ID = BObj->GetStringField(TEXT("ID"));
+    Boundary.DisplayDistance = (float)BObj->GetNumberField(TEXT("DisplayDistance"));
+    Boundary.bReverse = BObj->GetBoolField(TEXT("Reverse"));
+    Boundary.bBoundaryMoreVisible = BObj->GetBoolField(TEXT("BoundaryMoreVisible"));
+    Boundary.bAlertLimit = BObj->GetBoolField(TEXT("AlertLimit"));
+    Boundary.bMainBoundary = BObj->GetBoolField(TEXT("MainBoundary"));
+    Boundary.bVisible = BObj->GetBoolField(TEXT("Visible"));
+
+    // Color
+    const TSharedPtr<FJsonObject>* ColorObj;
+    if (BObj->TryGetObjectField(TEXT("BoundaryColor"), ColorObj))
+    {
+        Boundary.BoundaryColor = FLinearColor(
+            (float)(*ColorObj)->GetNumberField(TEXT("x")),
+            (float)(*ColorObj)->GetNumberField(TEXT("y")),
+            (float)(*ColorObj)->GetNumberField(TEXT("z")),
+            1.0f
+        );
+    }
+
+    // Points
+    const TArray<TSharedPtr<FJsonValue>>* PointsArray;
+    if (BObj->TryGetArrayField(TEXT("Points"), PointsArray))
+    {
+        for (const TSharedPtr<FJsonValue>& PointValue : *PointsArray)
+        {
+            const TSharedPtr<FJsonObject>& PObj = PointValue->AsObject();
+            if (!PObj.IsValid()) continue;
+
+            float px = (float)PObj->GetNumberField(TEXT("x"));
+            float py = (float)PObj->GetNumberField(TEXT("y"));
+            float pz = (float)PObj->GetNumberField(TEXT("z"));
+
+            Boundary.Points.Add(UnityToUnreal(px, py, pz));
+        }
+    }
+}
+
+bool UVaroniaBackOfficeManager::ParseSpatialConfig(const FString& JsonString, FSpatialConfig& OutConfig)
+{
     TSharedPtr<FJsonObject> RootObject;
     TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
 
     if (!FJsonSerializer::Deserialize(Reader, RootObject) || !RootObject.IsValid())
     {
-        UE_LOG(LogVaronia, Error, TEXT("Failed to parse NewSpatial.json"));
-        bSpatialConfigLoaded = false;
         return false;
     }
 
     // --- Root fields ---
-    SpatialConfig.ID = RootObject->GetStringField(TEXT("ID"));
-    SpatialConfig.Name = RootObject->GetStringField(TEXT("Name"));
-    SpatialConfig.AreaValue = RootObject->GetStringField(TEXT("AreaValue"));
-    SpatialConfig.MaxRect = RootObject->GetStringField(TEXT("MaxRect"));
-    SpatialConfig.GroupName = RootObject->GetStringField(TEXT("GroupName"));
-    SpatialConfig.MaxPlayer = (int32)RootObject->GetNumberField(TEXT("MaxPlayer"));
-    SpatialConfig.Multiplier = (float)RootObject->GetNumberField(TEXT("Multiplier"));
-    SpatialConfig.OrthoKey = RootObject->GetStringField(TEXT("OrthoKey"));
+    OutConfig.ID = RootObject->GetStringField(TEXT("ID"));
+    OutConfig.Name = RootObject->GetStringField(TEXT("Name"));
+    OutConfig.AreaValue = RootObject->GetStringField(TEXT("AreaValue"));
+    OutConfig.MaxRect = RootObject->GetStringField(TEXT("MaxRect"));
+    OutConfig.GroupName = RootObject->GetStringField(TEXT("GroupName"));
+    OutConfig.MaxPlayer = (int32)RootObject->GetNumberField(TEXT("MaxPlayer"));
+    OutConfig.Multiplier = (float)RootObject->GetNumberField(TEXT("Multiplier"));
+    OutConfig.OrthoKey = RootObject->GetStringField(TEXT("OrthoKey"));
 
     // --- SyncPos ---
     const TSharedPtr<FJsonObject>* SyncPosObj;
@@ -229,7 +579,7 @@ bool UVaroniaBackOfficeManager::LoadSpatialConfig()
         float sx = (float)(*SyncPosObj)->GetNumberField(TEXT("x"));
         float sy = (float)(*SyncPosObj)->GetNumberField(TEXT("y"));
         float sz = (float)(*SyncPosObj)->GetNumberField(TEXT("z"));
-        SpatialConfig.SyncPosition = UnityToUnreal(sx, sy, sz);
+        OutConfig.SyncPosition = UnityToUnreal(sx, sy, sz);
     }
 
     // --- SyncQuaternion ---
@@ -240,14 +590,14 @@ bool UVaroniaBackOfficeManager::LoadSpatialConfig()
         float qy = (float)(*SyncQuatObj)->GetNumberField(TEXT("y"));
         float qz = (float)(*SyncQuatObj)->GetNumberField(TEXT("z"));
         float qw = (float)(*SyncQuatObj)->GetNumberField(TEXT("w"));
-        SpatialConfig.SyncRotation = UnityQuatToUnrealRotator(qx, qy, qz, qw);
+        OutConfig.SyncRotation = UnityQuatToUnrealRotator(qx, qy, qz, qw);
     }
 
     // --- Boundaries ---
     const TArray<TSharedPtr<FJsonValue>>* BoundariesArray;
     if (RootObject->TryGetArrayField(TEXT("Boundaries"), BoundariesArray))
     {
-        SpatialConfig.Boundaries.Empty();
+        OutConfig.Boundaries.Empty();
 
         for (const TSharedPtr<FJsonValue>& BoundaryValue : *BoundariesArray)
         {
@@ -255,57 +605,15 @@ bool UVaroniaBackOfficeManager::LoadSpatialConfig()
             if (!BObj.IsValid()) continue;
 
             FSpatialBoundary Boundary;
-            Boundary.ID = BObj->GetStringField(TEXT("ID"));
-            Boundary.DisplayDistance = (float)BObj->GetNumberField(TEXT("DisplayDistance"));
-            Boundary.bReverse = BObj->GetBoolField(TEXT("Reverse"));
-            Boundary.bBoundaryMoreVisible = BObj->GetBoolField(TEXT("BoundaryMoreVisible"));
-            Boundary.bAlertLimit = BObj->GetBoolField(TEXT("AlertLimit"));
-            Boundary.bMainBoundary = BObj->GetBoolField(TEXT("MainBoundary"));
-            Boundary.bVisible = BObj->GetBoolField(TEXT("Visible"));
-
-            // Color
-            const TSharedPtr<FJsonObject>* ColorObj;
-            if (BObj->TryGetObjectField(TEXT("BoundaryColor"), ColorObj))
-            {
-                Boundary.BoundaryColor = FLinearColor(
-                    (float)(*ColorObj)->GetNumberField(TEXT("x")),
-                    (float)(*ColorObj)->GetNumberField(TEXT("y")),
-                    (float)(*ColorObj)->GetNumberField(TEXT("z")),
-                    1.0f
-                );
-            }
-
-            // Points
-            const TArray<TSharedPtr<FJsonValue>>* PointsArray;
-            if (BObj->TryGetArrayField(TEXT("Points"), PointsArray))
-            {
-                for (const TSharedPtr<FJsonValue>& PointValue : *PointsArray)
-                {
-                    const TSharedPtr<FJsonObject>& PObj = PointValue->AsObject();
-                    if (!PObj.IsValid()) continue;
+            ParseSpatialBoundary(BObj, Boundary);
 
-                    float px = (float)PObj->GetNumberField(TEXT("x"));
-                    float py = (float)PObj->GetNumberField(TEXT("y"));
-                    float pz = (float)PObj->GetNumberField(TEXT("z"));
-
-                    Boundary.Points.Add(UnityToUnreal(px, py, pz));
-                }
-            }
-
-            SpatialConfig.Boundaries.Add(Boundary);
+            OutConfig.Boundaries.Add(Boundary);
 
             UE_LOG(LogVaronia, Verbose, TEXT("  Boundary [%s]  %d points | Main=%d | Visible=%d"),
                 *Boundary.ID, Boundary.Points.Num(), Boundary.bMainBoundary, Boundary.bVisible);
         }
     }
 
-    bSpatialConfigLoaded = true;
-
-    UE_LOG(LogVaronia, Log, TEXT("Spatial loaded: %s (%s)  %d boundaries"),
-        *SpatialConfig.Name, *SpatialConfig.AreaValue, SpatialConfig.Boundaries.Num());
-    UE_LOG(LogVaronia, Verbose, TEXT("  SyncPos: %s"), *SpatialConfig.SyncPosition.ToString());
-    UE_LOG(LogVaronia, Verbose, TEXT("  SyncRot: %s"), *SpatialConfig.SyncRotation.ToString());
-
     return true;
 }
 
@@ -337,4 +645,648 @@ TArray<FSpatialBoundary> UVaroniaBackOfficeManager::GetSubBoundaries() const
         }
     }
     return Result;
-}
\ No newline at end of file
+}
+
+// ============================================================================
+// Remote Poses
+// ============================================================================
+
+bool UVaroniaBackOfficeManager::IsSpectator() const
+{
+    return CurrentConfig.DeviceMode == EDeviceMode::Server_Spectator
+        || CurrentConfig.DeviceMode == EDeviceMode::Client_Spectator;
+}
+
+void UVaroniaBackOfficeManager::HandleMqttMessage(const FString& Topic, const TArray<uint8>& Payload)
+{
+    if (Topic.StartsWith(VaroniaMqttTopics::Pose))
+    {
+        FVaroniaPoseMessage Message;
+        if (!IsSpectator() || !FVaroniaPoseMessage::Decode(Payload, Message)) return;
+        if (Message.DeviceID == CurrentConfig.MQTT_IDClient) return;
+
+        if (IsServer()) { Fleet.MarkSeen(Message.DeviceID, FPlatformTime::Seconds()); }
+        Heatmap.AddSample(Message.Location);
+
+        // Same rule as PublishLocalPose: a device fed by SubmitTrackedPose keeps that single stream
+        if (FindTrackedSlot(Message.DeviceID, false) == INDEX_NONE)
+        {
+            Crossings.AddPose(Message.DeviceID, Message.Location, Message.Timestamp);
+        }
+
+        FVaroniaPoseJitterBuffer* Buffer = RemotePoses.Find(Message.DeviceID);
+        if (!Buffer)
+        {
+            Buffer = &RemotePoses.Add(Message.DeviceID);
+            SET_MEMORY_STAT(STAT_Varonia_PoseBufferMemory, RemotePoses.GetAllocatedSize());
+        }
+        Buffer->Push(Message.Timestamp, FPlatformTime::Seconds(), Message.Location, Message.Rotation);
+    }
+    else if (Topic.StartsWith(VaroniaMqttTopics::Status))
+    {
+        HandleStatusMessage(Payload);
+    }
+    else if (Topic == VaroniaMqttTopics::TimeRequest)
+    {
+        HandleTimeRequest(Payload);
+    }
+    else if (Topic == VaroniaMqttTopics::TimeServer)
+    {
+        int32 DeviceID = INDEX_NONE;
+        if (Payload.Num() == sizeof(int32))
+        {
+            FMemoryReader Reader(Payload);
+            Reader << DeviceID;
+        }
+        if (DeviceID >= 0 && DeviceID != CurrentConfig.MQTT_IDClient)
+        {
+            TimeServersSeen.Add(DeviceID, FPlatformTime::Seconds());
+        }
+    }
+    else if (Topic.StartsWith(VaroniaMqttTopics::TimeReply))
+    {
+        HandleTimeReply(Payload);
+    }
+    else if (Topic.StartsWith(VaroniaMqttTopics::Config))
+    {
+        HandleConfigPatch(Payload, Topic.EndsWith(TEXT("/All")));
+    }
+}
+
+void UVaroniaBackOfficeManager::PublishLocalPose(const FTransform& Pose)
+{
+    Heatmap.AddSample(Pose.GetLocation());
+
+    // Once a tracker thread submits this device's poses (its slot is claimed before its first
+    // crossing test), that thread feeds the crossings; two pose streams would make false crossings
+    const int32 DeviceID = CurrentConfig.MQTT_IDClient;
+    if (FindTrackedSlot(DeviceID, false) == INDEX_NONE)
+    {
+        Crossings.AddPose(DeviceID, Pose.GetLocation(), FPlatformTime::Seconds());
+    }
+
+    if (!MqttHandler || !MqttHandler->IsConnected()) return;
+
+    FVaroniaPoseMessage Message;
+    Message.DeviceID = CurrentConfig.MQTT_IDClient;
+    Message.Timestamp = FPlatformTime::Seconds();
+    Message.Location = Pose.GetLocation();
+    Message.Rotation = Pose.GetRotation();
+
+    TArray<uint8> Bytes;
+    Message.Encode(Bytes);
+    MqttHandler->PublishBytes(FString::Printf(TEXT("%s/%d"), VaroniaMqttTopics::Pose, Message.DeviceID), Bytes);
+}
+
+bool UVaroniaBackOfficeManager::SampleRemotePose(int32 DeviceID, FTransform& OutPose)
+{
+    FVaroniaPoseJitterBuffer* Buffer = RemotePoses.Find(DeviceID);
+    if (!Buffer) return false;
+
+    // Frame start time so every device is sampled at the same instant
+    return Buffer->Sample(FApp::GetCurrentTime(), OutPose);
+}
+
+TArray<int32> UVaroniaBackOfficeManager::GetRemotePoseDevices() const
+{
+    TArray<int32> Result;
+    RemotePoses.GetKeys(Result);
+    return Result;
+}
+
+FVaroniaJitterStats UVaroniaBackOfficeManager::GetRemotePoseStats(int32 DeviceID) const
+{
+    const FVaroniaPoseJitterBuffer* Buffer = RemotePoses.Find(DeviceID);
+    return Buffer ? Buffer->GetStats() : FVaroniaJitterStats();
+}
+
+// ============================================================================
+// Tracked Poses
+// ============================================================================
+
+int32 UVaroniaBackOfficeManager::FindTrackedSlot(int32 DeviceID, bool bClaim)
+{
+    static_assert(FMath::IsPowerOfTwo(MaxTrackedDevices), "Slots are probed with a mask");
+    if (!TrackedDeviceIDs || DeviceID < 0) return INDEX_NONE;
+
+    for (int32 Probe = 0; Probe < MaxTrackedDevices; ++Probe)
+    {
+        const int32 Slot = (DeviceID + Probe) & (MaxTrackedDevices - 1);
+        int32 Owner = TrackedDeviceIDs[Slot].load(std::memory_order_acquire);
+        if (Owner == DeviceID) return Slot;
+        if (Owner != INDEX_NONE) continue;
+
+        // Free slots are only ever at the end of a probe sequence
+        if (!bClaim) return INDEX_NONE;
+        if (TrackedDeviceIDs[Slot].compare_exchange_strong(Owner, DeviceID, std::memory_order_acq_rel) || Owner == DeviceID)
+        {
+            return Slot;
+        }
+    }
+    return INDEX_NONE;
+}
+
+void UVaroniaBackOfficeManager::SubmitTrackedPose(int32 DeviceID, const FTransform& Pose, double Timestamp)
+{
+    const int32 Slot = FindTrackedSlot(DeviceID, true);
+    if (Slot == INDEX_NONE)
+    {
+        if (DeviceID >= 0 && TrackedDeviceIDs && !bTrackedPosesFullLogged.exchange(true))
+        {
+            UE_LOG(LogVaronia, Warning, TEXT("SubmitTrackedPose: more than %d tracked devices, device %d ignored"), MaxTrackedDevices, DeviceID);
+        }
+        return;
+    }
+
+    FVaroniaTrackedPose& Sample = TrackedPoses[Slot].GetWriteBuffer();
+    Sample.Pose = Pose;
+    Sample.Timestamp = Timestamp;
+    TrackedPoses[Slot].Publish();
+
+    // Every sample, not just the latched ones, so fast crossings are not missed
+    Crossings.AddPose(DeviceID, Pose.GetLocation(), Timestamp);
+}
+
+void UVaroniaBackOfficeManager::LatchTrackedPoses()
+{
+    for (int32 Slot = 0; Slot < MaxTrackedDevices; ++Slot)
+    {
+        const int32 DeviceID = TrackedDeviceIDs[Slot].load(std::memory_order_acquire);
+        if (DeviceID == INDEX_NONE) continue;
+
+        // Intermediate samples are dropped: only the newest matters once per frame
+        TrackedPoses[Slot].Update();
+        if (DeviceID != CurrentConfig.MQTT_IDClient) continue;
+
+        // Not Update()'s result: a late-latching GetTrackedPose may already have taken this sample
+        const FVaroniaTrackedPose& Sample = TrackedPoses[Slot].GetReadBuffer();
+        if (Sample.Timestamp > LastPublishedTrackedTime)
+        {
+            LastPublishedTrackedTime = Sample.Timestamp;
+            PublishLocalPose(Sample.Pose);
+        }
+    }
+}
+
+void UVaroniaBackOfficeManager::DispatchBoundaryCrossings()
+{
+    Crossings.ConsumeEvents(CrossingEvents);
+    for (const FVaroniaBoundaryCrossing& Crossing : CrossingEvents)
+    {
+        const int32 Index = SpatialConfig.Boundaries.IndexOfByPredicate(
+            [&Crossing](const FSpatialBoundary& Boundary) { return Boundary.ID == Crossing.BoundaryID; });
+        if (Crossing.bEntered)
+        {
+            VARONIA_JOURNAL(BoundaryEntered, Crossing.DeviceID, Index);
+        }
+        else
+        {
+            VARONIA_JOURNAL(BoundaryExited, Crossing.DeviceID, Index);
+        }
+        UE_LOG(LogVaronia, Verbose, TEXT("Device %d %s %s"), Crossing.DeviceID, Crossing.bEntered ? TEXT("entered") : TEXT("left"), *Crossing.BoundaryID);
+
+        OnBoundaryCrossed.Broadcast(Crossing);
+    }
+}
+
+bool UVaroniaBackOfficeManager::GetTrackedPose(int32 DeviceID, FTransform& OutPose, bool bLateLatch)
+{
+    check(IsInGameThread());
+    const int32 Slot = FindTrackedSlot(DeviceID, false);
+    if (Slot == INDEX_NONE) return false;
+
+    TVaroniaTripleBuffer<FVaroniaTrackedPose>& Buffer = TrackedPoses[Slot];
+    if (bLateLatch)
+    {
+        Buffer.Update();
+    }
+
+    const FVaroniaTrackedPose& Sample = Buffer.GetReadBuffer();
+    if (Sample.Timestamp <= 0.0) return false;
+
+    OutPose = Sample.Pose;
+    return true;
+}
+
+// ============================================================================
+// Clock Sync
+// ============================================================================
+
+bool UVaroniaBackOfficeManager::IsServer() const
+{
+    return CurrentConfig.DeviceMode == EDeviceMode::Server_Spectator
+        || CurrentConfig.DeviceMode == EDeviceMode::Server_Player;
+}
+
+void UVaroniaBackOfficeManager::SendTimeRequest()
+{
+    FVaroniaTimeMessage Request;
+    Request.DeviceID = CurrentConfig.MQTT_IDClient;
+    Request.OriginTime = FPlatformTime::Seconds();
+
+    TArray<uint8> Bytes;
+    Request.Encode(Bytes);
+    MqttHandler->PublishBytes(VaroniaMqttTopics::TimeRequest, Bytes);
+}
+
+void UVaroniaBackOfficeManager::HandleTimeRequest(const TArray<uint8>& Payload)
+{
+    const double ReceiveTime = FPlatformTime::Seconds();
+
+    FVaroniaTimeMessage Message;
+    if (!IsTimeServer() || !FVaroniaTimeMessage::Decode(Payload, Message)) return;
+
+    Message.ServerID = CurrentConfig.MQTT_IDClient;
+    Message.ReceiveTime = ReceiveTime;
+    Message.TransmitTime = FPlatformTime::Seconds();
+
+    TArray<uint8> Bytes;
+    Message.Encode(Bytes);
+    MqttHandler->PublishBytes(FString::Printf(TEXT("%s/%d"), VaroniaMqttTopics::TimeReply, Message.DeviceID), Bytes);
+}
+
+void UVaroniaBackOfficeManager::HandleTimeReply(const TArray<uint8>& Payload)
+{
+    const double ArrivalTime = FPlatformTime::Seconds();
+
+    FVaroniaTimeMessage Message;
+    if (!FVaroniaTimeMessage::Decode(Payload, Message) || Message.DeviceID != CurrentConfig.MQTT_IDClient) return;
+
+    // Servers that still think they were elected (startup, failover) answer too
+    if (Message.ServerID != ClockServerID) return;
+
+    const bool bWasSynced = ClockSync.IsSynced();
+    ClockSync.AddExchange(Message.OriginTime, Message.ReceiveTime, Message.TransmitTime, ArrivalTime);
+
+    if (!bWasSynced && ClockSync.IsSynced())
+    {
+        UE_LOG(LogVaronia, Log, TEXT("Clock synced to server (error bound %.2f ms, drift %.1f ppm)"),
+            ClockSync.GetErrorBound() * 1000.0, ClockSync.GetDriftPpm());
+        VARONIA_JOURNAL(ClockSynced, (int64)(ClockSync.GetErrorBound() * 1e6), (int64)(ClockSync.GetDriftPpm() * 1000.0));
+    }
+}
+
+bool UVaroniaBackOfficeManager::IsTimeServer() const
+{
+    return IsServer() && ClockServerID == CurrentConfig.MQTT_IDClient;
+}
+
+int32 UVaroniaBackOfficeManager::ElectTimeServer() const
+{
+    if (TimeServerID >= 0) return TimeServerID;
+
+    // A server stops counting 3 announcements after it went quiet; the next lowest takes over
+    const double Now = FPlatformTime::Seconds();
+    int32 Elected = IsServer() ? CurrentConfig.MQTT_IDClient : INDEX_NONE;
+    for (const TPair<int32, double>& Server : TimeServersSeen)
+    {
+        if (Now - Server.Value < 3.0 && (Elected == INDEX_NONE || Server.Key < Elected))
+        {
+            Elected = Server.Key;
+        }
+    }
+    return Elected;
+}
+
+double UVaroniaBackOfficeManager::GetSyncedTime(double& OutErrorBound) const
+{
+    if (IsTimeServer())
+    {
+        OutErrorBound = 0.0;
+        return FPlatformTime::Seconds();
+    }
+
+    OutErrorBound = ClockSync.GetErrorBound();
+    return ClockSync.ToServerTime(FPlatformTime::Seconds());
+}
+
+double UVaroniaBackOfficeManager::LocalToSyncedTime(double LocalTime) const
+{
+    return IsTimeServer() ? LocalTime : ClockSync.ToServerTime(LocalTime);
+}
+
+bool UVaroniaBackOfficeManager::IsClockSynced() const
+{
+    return IsTimeServer() || ClockSync.IsSynced();
+}
+
+// ============================================================================
+// Fleet
+// ============================================================================
+
+void UVaroniaBackOfficeManager::SendHeartbeat()
+{
+    // Liveness only: the SoftState goes out once per change through PublishSoftState (retained)
+    const FString Message = UVaroniaMqttLibrary::FormatMqttMessage(CurrentConfig.MQTT_IDClient, TEXT("Heartbeat"),
+        -1, CurrentConfig.PlayerName);
+    MqttHandler->Publish(FString::Printf(TEXT("%s/%d"), VaroniaMqttTopics::Status, CurrentConfig.MQTT_IDClient), Message);
+
+    // Time server election: every server announces itself, the lowest live ID answers
+    if (IsServer())
+    {
+        TArray<uint8> Bytes;
+        FMemoryWriter Writer(Bytes);
+        int32 DeviceID = CurrentConfig.MQTT_IDClient;
+        Writer << DeviceID;
+        MqttHandler->PublishBytes(VaroniaMqttTopics::TimeServer, Bytes);
+    }
+}
+
+void UVaroniaBackOfficeManager::HandleStatusMessage(const TArray<uint8>& Payload)
+{
+    if (!IsServer()) return;
+
+    FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Payload.GetData()), Payload.Num());
+    FVaroniaMqttPayload Message;
+    if (!UVaroniaMqttLibrary::ParseMqttMessage(FString(Text.Length(), Text.Get()), Message)) return;
+
+    // SoftState is retained, so the broker replays it for devices that left long ago: only heartbeats prove liveness
+    const int32 DeviceID = Message.CallerDeviceID;
+    if (Message.sMethod == TEXT("Heartbeat"))
+    {
+        Fleet.MarkSeen(DeviceID, FPlatformTime::Seconds());
+    }
+
+    if (Message.Items.SoftState >= 0 && StaticEnum<ESoftState>()->IsValidEnumValue(Message.Items.SoftState))
+    {
+        Fleet.SetSoftState(DeviceID, (ESoftState)Message.Items.SoftState);
+    }
+    if (!Message.Items.PlayerName.IsEmpty())
+    {
+        Fleet.SetPlayerName(DeviceID, Message.Items.PlayerName);
+    }
+}
+
+// ============================================================================
+// Device Status
+// ============================================================================
+
+void UVaroniaBackOfficeManager::UpdateDeviceStatus(const FVaroniaDeviceStatus& Status)
+{
+    if (!MqttHandler) return;
+    MqttHandler->UpdateReplicatedStruct(DeviceStatusChannel, Status);
+}
+
+bool UVaroniaBackOfficeManager::GetDeviceStatus(int32 DeviceID, FVaroniaDeviceStatus& OutStatus) const
+{
+    const FVaroniaDeviceStatus* Status = MqttHandler ? MqttHandler->GetMirroredStruct<FVaroniaDeviceStatus>(DeviceStatusChannel, DeviceID) : nullptr;
+    if (!Status) return false;
+
+    OutStatus = *Status;
+    return true;
+}
+
+// ============================================================================
+// SoftState
+// ============================================================================
+
+bool UVaroniaBackOfficeManager::TrySetSoftState(ESoftState NewState)
+{
+    if (!SoftStateMachine.TryTransition(NewState, FPlatformTime::Seconds()))
+    {
+        if (NewState != CurrentSoftState)
+        {
+            VARONIA_JOURNAL(SoftStateRejected, (int64)CurrentSoftState, (int64)NewState);
+        }
+        return false;
+    }
+
+    VARONIA_JOURNAL(SoftStateChanged, (int64)CurrentSoftState, (int64)NewState);
+    CurrentSoftState = NewState;
+    PublishSoftState();
+    return true;
+}
+
+TArray<FVaroniaSoftStateMetrics> UVaroniaBackOfficeManager::GetSoftStateMetrics() const
+{
+    return SoftStateMachine.GetMetrics(FPlatformTime::Seconds());
+}
+
+void UVaroniaBackOfficeManager::HandleMqttConnected()
+{
+    // The broker forgot us; the next publish must go out even if the value is unchanged
+    LastPublishedSoftState = -1;
+    PublishSoftState();
+}
+
+void UVaroniaBackOfficeManager::PublishSoftState()
+{
+    const int32 Value = (int32)CurrentSoftState;
+    if (!MqttHandler || !MqttHandler->IsConnected() || Value == LastPublishedSoftState) return;
+
+    const FString Message = UVaroniaMqttLibrary::FormatMqttMessage(CurrentConfig.MQTT_IDClient, TEXT("SoftState"), Value);
+    MqttHandler->Publish(FString::Printf(TEXT("%s/%d"), VaroniaMqttTopics::Status, CurrentConfig.MQTT_IDClient), Message, 1, true);
+    LastPublishedSoftState = Value;
+}
+
+// ============================================================================
+// Remote Config
+// ============================================================================
+
+void UVaroniaBackOfficeManager::HandleConfigPatch(const TArray<uint8>& Payload, bool bAllDevices)
+{
+    FVaroniaConfigPatch Patch;
+    if (!FVaroniaConfigPatch::Parse(Payload, Patch))
+    {
+        UE_LOG(LogVaronia, Warning, TEXT("Ignoring malformed config patch"));
+        return;
+    }
+
+    // Retained patches come back on every reconnect
+    int64& AppliedVersion = bAllDevices ? AppliedConfigAllVersion : AppliedConfigVersion;
+    if (Patch.Version <= AppliedVersion)
+    {
+        UE_LOG(LogVaronia, Verbose, TEXT("Config patch v%lld (%s) already applied"), Patch.Version, bAllDevices ? TEXT("All") : TEXT("device"));
+        return;
+    }
+
+    // Both sections are applied to copies and only swapped in if everything parsed
+    FLBEConfig NewConfig = CurrentConfig;
+    FSpatialConfig NewSpatial;
+    TArray<FName> Changed;
+    FString Error;
+
+    bool bValid = Patch.ApplyConfig(NewConfig, Changed, Error);
+    if (bValid && Patch.Spatial.IsValid())
+    {
+        NewSpatial = SpatialConfig;
+        bValid = FVaroniaConfigPatch::ApplySpatial(*Patch.Spatial, NewSpatial, Error);
+    }
+    if (!bValid)
+    {
+        UE_LOG(LogVaronia, Error, TEXT("Config patch v%lld rejected: %s"), Patch.Version, *Error);
+        return;
+    }
+
+    for (const FName& Field : Changed)
+    {
+        PendingConfigWrites.Add(Field.ToString(), FVaroniaConfigPatch::ConfigFieldToJson(Field, NewConfig));
+    }
+
+    // The MQTT subscriptions and the device role were set up with the launch values; switching them
+    // mid-session would leave this device listening on the old topics, so they wait for the next launch
+    Changed.RemoveAll([this, &NewConfig](const FName& Field)
+    {
+        if (!FVaroniaConfigPatch::IsLaunchOnlyField(Field)) return false;
+
+        FLBEConfig::StaticStruct()->FindPropertyByName(Field)->CopyCompleteValue_InContainer(&NewConfig, &CurrentConfig);
+        UE_LOG(LogVaronia, Warning, TEXT("  %s changed, takes effect on next launch"), *Field.ToString());
+        return true;
+    });
+
+    CurrentConfig = MoveTemp(NewConfig);
+    AppliedVersion = Patch.Version;
+    VARONIA_JOURNAL(ConfigPatched, Patch.Version, Changed.Num());
+
+    // Spatial patch versions are journaled with the patch, so a recalibration that drops the journal
+    // also lets the retained patch apply again
+    if (!Patch.Spatial.IsValid())
+    {
+        PendingConfigWrites.Add(bAllDevices ? TEXT("ConfigVersionAll") : TEXT("ConfigVersion"), MakeShared<FJsonValueNumber>((double)Patch.Version));
+    }
+    ConfigWriteTime = FPlatformTime::Seconds() + 1.0;
+
+    if (Patch.Spatial.IsValid())
+    {
+        const FBox2D ChangedArea = FVaroniaPlacementPoints::GetChangedArea(SpatialConfig, NewSpatial);
+        SpatialConfig = MoveTemp(NewSpatial);
+        Placement.Update(SpatialConfig, ChangedArea);
+        Heatmap.Init(SpatialConfig, HeatmapCellSize, HeatmapContactDistance);
+        Crossings.Build(SpatialConfig, BoundaryHysteresis);
+        AppendSpatialJournal(Patch.Spatial, Patch.Version, bAllDevices);
+    }
+
+    UE_LOG(LogVaronia, Log, TEXT("Config patch v%lld applied (%d fields changed%s)"),
+        Patch.Version, Changed.Num(), Patch.Spatial.IsValid() ? TEXT(", spatial updated") : TEXT(""));
+
+    for (const FName& Field : Changed)
+    {
+        OnConfigFieldChanged.Broadcast(Field);
+    }
+    if (Patch.Spatial.IsValid())
+    {
+        OnSpatialPatched.Broadcast();
+    }
+}
+
+void UVaroniaBackOfficeManager::FlushConfigWrites()
+{
+    if (PendingConfigWrites.Num() == 0) return;
+
+    // Merged into the file as it is on disk, so fields written by other Varonia tools survive
+    ConfigWriteTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Path = GetConfigPath(), Fields = MoveTemp(PendingConfigWrites)]()
+    {
+        TSharedPtr<FJsonObject> Root;
+        FString JsonString;
+        if (FFileHelper::LoadFileToString(JsonString, *Path))
+        {
+            TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+            FJsonSerializer::Deserialize(Reader, Root);
+        }
+        if (!Root.IsValid())
+        {
+            Root = MakeShared<FJsonObject>();
+        }
+
+        for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Fields)
+        {
+            Root->SetField(Field.Key, Field.Value);
+        }
+
+        FString OutputString;
+        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputString);
+        const FString TempPath = Path + TEXT(".tmp");
+        if (FJsonSerializer::Serialize(Root.ToSharedRef(), Writer) && FFileHelper::SaveStringToFile(OutputString, *TempPath))
+        {
+            IFileManager::Get().Move(*Path, *TempPath, true);
+        }
+    }, ConfigWriteTask);
+
+    PendingConfigWrites.Reset();
+}
+
+void UVaroniaBackOfficeManager::AppendSpatialJournal(const TSharedPtr<FJsonObject>& SpatialPatch, int64 Version, bool bAllDevices)
+{
+    if (SpatialFilePath.IsEmpty()) return;
+
+    // Entries are tied to the spatial file they patch: a recalibration rewrites it and drops them
+    TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+    Entry->SetStringField(TEXT("Base"), LexToString(IFileManager::Get().GetTimeStamp(*SpatialFilePath).GetTicks()));
+    Entry->SetNumberField(TEXT("Version"), (double)Version);
+    Entry->SetBoolField(TEXT("All"), bAllDevices);
+    Entry->SetObjectField(TEXT("Spatial"), SpatialPatch);
+
+    FString Line;
+    TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+    if (!FJsonSerializer::Serialize(Entry, Writer)) return;
+
+    ConfigWriteTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Path = SpatialFilePath + TEXT(".patches"), Line = Line + LINE_TERMINATOR]()
+    {
+        FFileHelper::SaveStringToFile(Line, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+    }, ConfigWriteTask);
+}
+
+void UVaroniaBackOfficeManager::ReplaySpatialJournal(const FString& FilePath)
+{
+    const FString JournalPath = FilePath + TEXT(".patches");
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *JournalPath)) return;
+
+    const FString Base = LexToString(IFileManager::Get().GetTimeStamp(*FilePath).GetTicks());
+    int32 Applied = 0;
+
+    for (const FString& Line : Lines)
+    {
+        TSharedPtr<FJsonObject> Entry;
+        TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Line);
+        if (!FJsonSerializer::Deserialize(Reader, Entry) || !Entry.IsValid()) continue;
+        if (Entry->GetStringField(TEXT("Base")) != Base) continue;
+
+        const TSharedPtr<FJsonObject>* SpatialPatch = nullptr;
+        FString Error;
+        if (Entry->TryGetObjectField(TEXT("Spatial"), SpatialPatch)
+            && FVaroniaConfigPatch::ApplySpatial(**SpatialPatch, SpatialConfig, Error))
+        {
+            bool bAllDevices = false;
+            Entry->TryGetBoolField(TEXT("All"), bAllDevices);
+            int64& AppliedVersion = bAllDevices ? AppliedConfigAllVersion : AppliedConfigVersion;
+            AppliedVersion = FMath::Max(AppliedVersion, (int64)Entry->GetNumberField(TEXT("Version")));
+            ++Applied;
+        }
+    }
+
+    if (Applied == 0)
+    {
+        IFileManager::Get().Delete(*JournalPath);
+    }
+    else
+    {
+        UE_LOG(LogVaronia, Log, TEXT("Spatial: %d back office patches replayed"), Applied);
+    }
+}
+
+// ============================================================================
+// Occupancy
+// ============================================================================
+
+TMap<FString, int32> UVaroniaBackOfficeManager::GetBoundaryContacts() const
+{
+    TMap<FString, int32> Result;
+    for (const TPair<FString, uint32>& Contact : Heatmap.GetContacts())
+    {
+        Result.Add(Contact.Key, (int32)FMath::Min(Contact.Value, (uint32)MAX_int32));
+    }
+    return Result;
+}
+
+bool UVaroniaBackOfficeManager::ExportHeatmap(const FString& BasePath)
+{
+    const FString Base = BasePath.IsEmpty()
+        ? FPaths::ProjectSavedDir() / TEXT("Varonia/Heatmaps") / FDateTime::Now().ToString()
+        : BasePath;
+
+    const bool bExported = Heatmap.ExportPNG(Base + TEXT(".png")) && Heatmap.ExportBinary(Base + TEXT(".vhm"));
+    UE_LOG(LogVaronia, Log, TEXT("Occupancy heatmap %s: %s (%dx%d)"),
+        bExported ? TEXT("exported") : TEXT("export failed"), *Base, Heatmap.GetWidth(), Heatmap.GetHeight());
+    return bExported;
+}
@@ -0,0 +1,166 @@
+#include "VaroniaBoundaryCrossings.h"
+#include "VaroniaSpatialMath.h"
+#include "VaroniaFleetTable.h"
+#include "Misc/ScopeLock.h"
+
+void FVaroniaBoundaryCrossings::Build(const FSpatialConfig& Config, float InHysteresis)
+{
+    FWriteScopeLock Lock(ZonesLock);
+
+    Hysteresis = FMath::Max(InHysteresis, 0.f);
+    Zones.Reset();
+    for (const FSpatialBoundary& Boundary : Config.Boundaries)
+    {
+        if (Boundary.bMainBoundary || Boundary.Points.Num() < 3) continue;
+
+        FZone& Zone = Zones.AddDefaulted_GetRef();
+        Zone.ID = Boundary.ID;
+        Zone.Points = Boundary.Points;
+        Zone.Bounds = VaroniaSpatial::GetBounds2D(Boundary.Points).ExpandBy(Hysteresis);
+    }
+
+    for (TPair<int32, TUniquePtr<FDeviceState>>& Device : Devices)
+    {
+        Device.Value->bValid = false;
+    }
+}
+
+void FVaroniaBoundaryCrossings::AddPose(int32 DeviceID, const FVector& Location, double Time)
+{
+    if (DeviceID < 0 || DeviceID >= FVaroniaFleetTable::MaxDeviceID) return;
+
+    const FVector2D P(Location.X, Location.Y);
+    {
+        FReadScopeLock Lock(ZonesLock);
+        if (const TUniquePtr<FDeviceState>* Device = Devices.Find(DeviceID))
+        {
+            UpdateDevice(DeviceID, **Device, P, Time);
+            return;
+        }
+    }
+
+    // First pose of this device: the map changes, so exclusively (once per device)
+    {
+        FWriteScopeLock Lock(ZonesLock);
+        TUniquePtr<FDeviceState>& Device = Devices.FindOrAdd(DeviceID);
+        if (!Device.IsValid())
+        {
+            Device = MakeUnique<FDeviceState>();
+        }
+    }
+
+    FReadScopeLock Lock(ZonesLock);
+    UpdateDevice(DeviceID, *Devices.FindChecked(DeviceID), P, Time);
+}
+
+void FVaroniaBoundaryCrossings::UpdateDevice(int32 DeviceID, FDeviceState& Device, const FVector2D& P, double Time)
+{
+    FScopeLock DeviceLock(&Device.Mutex);
+
+    // First pose: take the sides as they are, nothing was crossed
+    if (!Device.bValid)
+    {
+        Device.Zones.SetNum(Zones.Num());
+        for (int32 i = 0; i < Zones.Num(); ++i)
+        {
+            FZoneState& State = Device.Zones[i];
+            State.bSide = State.bInside = VaroniaSpatial::IsInsidePolygon(Zones[i].Points, P);
+        }
+    }
+    else
+    {
+        const FBox2D Swept(FVector2D::Min(Device.Last, P), FVector2D::Max(Device.Last, P));
+        for (int32 i = 0; i < Zones.Num(); ++i)
+        {
+            if (Zones[i].Bounds.Intersect(Swept))
+            {
+                Sweep(DeviceID, Zones[i], Device.Zones[i], Device.Last, Device.LastTime, P, Time);
+            }
+        }
+    }
+
+    Device.Last = P;
+    Device.LastTime = Time;
+    Device.bValid = true;
+}
+
+void FVaroniaBoundaryCrossings::Sweep(int32 DeviceID, const FZone& Zone, FZoneState& State, const FVector2D& A, double TimeA, const FVector2D& B, double TimeB)
+{
+    // Where A -> B crosses the outline, as fractions of the segment. A itself was the end of the
+    // previous segment, and each vertex belongs to one edge only, so no crossing is counted twice.
+    TArray<double, TInlineAllocator<8>> Hits;
+    const FVector2D AB = B - A;
+    const TArray<FVector>& Points = Zone.Points;
+    for (int32 i = 0, j = Points.Num() - 1; i < Points.Num(); j = i++)
+    {
+        const FVector2D C(Points[j].X, Points[j].Y);
+        const FVector2D CD = FVector2D(Points[i].X, Points[i].Y) - C;
+        const double Denom = FVector2D::CrossProduct(AB, CD);
+        if (FMath::Abs(Denom) < UE_SMALL_NUMBER) continue;
+
+        const FVector2D AC = C - A;
+        const double T = FVector2D::CrossProduct(AC, CD) / Denom;
+        const double U = FVector2D::CrossProduct(AC, AB) / Denom;
+        if (T > 0.0 && T <= 1.0 && U >= 0.0 && U < 1.0)
+        {
+            Hits.Add(T);
+        }
+    }
+    Hits.Sort();
+
+    // Walk the stretches between hits; one that goes deep enough past the edge is reported, so
+    // passing through a small zone within one segment still gives enter then exit
+    const double HysteresisSq = FMath::Square(Hysteresis);
+    double Prev = 0.0;
+    for (double T : Hits)
+    {
+        if (State.bSide != State.bInside
+            && VaroniaSpatial::DistSquaredToPolygonEdge(Points, A + AB * ((Prev + T) * 0.5)) >= HysteresisSq)
+        {
+            Commit(DeviceID, Zone, State);
+        }
+
+        State.bSide = !State.bSide;
+        if (State.bSide != State.bInside)
+        {
+            State.PendingTime = FMath::Lerp(TimeA, TimeB, T);
+        }
+        Prev = T;
+    }
+
+    // Grazing a vertex can fool the parity; the end point decides
+    const bool bSideB = VaroniaSpatial::IsInsidePolygon(Points, B);
+    if (bSideB != State.bSide)
+    {
+        State.bSide = bSideB;
+        State.PendingTime = TimeB;
+    }
+
+    if (State.bSide != State.bInside && VaroniaSpatial::DistSquaredToPolygonEdge(Points, B) >= HysteresisSq)
+    {
+        Commit(DeviceID, Zone, State);
+    }
+}
+
+void FVaroniaBoundaryCrossings::Commit(int32 DeviceID, const FZone& Zone, FZoneState& State)
+{
+    State.bInside = State.bSide;
+
+    FVaroniaBoundaryCrossing Crossing;
+    Crossing.DeviceID = DeviceID;
+    Crossing.BoundaryID = Zone.ID;
+    Crossing.bEntered = State.bInside;
+    Crossing.Time = State.PendingTime;
+    Events.Enqueue(MoveTemp(Crossing));
+}
+
+void FVaroniaBoundaryCrossings::ConsumeEvents(TArray<FVaroniaBoundaryCrossing>& OutEvents)
+{
+    OutEvents.Reset();
+
+    FVaroniaBoundaryCrossing Crossing;
+    while (Events.Dequeue(Crossing))
+    {
+        OutEvents.Add(MoveTemp(Crossing));
+    }
+}
@@ -0,0 +1,104 @@
+#include "VaroniaClockSync.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// ============================================================================
+// Wire format
+// ============================================================================
+
+void FVaroniaTimeMessage::Encode(TArray<uint8>& OutBytes) const
+{
+    OutBytes.Reset(32);
+    FMemoryWriter Writer(OutBytes);
+
+    int32 ID = DeviceID;
+    int32 Server = ServerID;
+    double T1 = OriginTime;
+    double T2 = ReceiveTime;
+    double T3 = TransmitTime;
+    Writer << ID << Server << T1 << T2 << T3;
+}
+
+bool FVaroniaTimeMessage::Decode(const TArray<uint8>& Bytes, FVaroniaTimeMessage& OutMessage)
+{
+    if (Bytes.Num() != 32) return false;
+
+    FMemoryReader Reader(Bytes);
+    Reader << OutMessage.DeviceID << OutMessage.ServerID << OutMessage.OriginTime << OutMessage.ReceiveTime << OutMessage.TransmitTime;
+    return !Reader.IsError();
+}
+
+// ============================================================================
+// Estimator
+// ============================================================================
+
+void FVaroniaClockSync::Reset()
+{
+    NextSample = 0;
+    NumSamples = 0;
+    ReferenceTime = 0.0;
+    Offset = 0.0;
+    Drift = 0.0;
+    ErrorBound = DBL_MAX;
+}
+
+void FVaroniaClockSync::AddExchange(double T1, double T2, double T3, double T4)
+{
+    FExchange& Exchange = Window[NextSample];
+    Exchange.LocalTime = (T1 + T4) * 0.5;
+    Exchange.Offset = ((T2 - T1) + (T3 - T4)) * 0.5;
+    Exchange.Delay = FMath::Max((T4 - T1) - (T3 - T2), 0.0);
+
+    NextSample = (NextSample + 1) % WindowSize;
+    NumSamples = FMath::Min(NumSamples + 1, WindowSize);
+
+    Solve();
+}
+
+void FVaroniaClockSync::Solve()
+{
+    // Queueing delay only ever adds error, so trust the fastest round trips
+    TArray<FExchange, TInlineAllocator<WindowSize>> Best(Window, NumSamples);
+    Best.Sort([](const FExchange& A, const FExchange& B) { return A.Delay < B.Delay; });
+    Best.SetNum(FMath::Max(NumSamples / 2, FMath::Min(NumSamples, 4)));
+
+    double MeanTime = 0.0;
+    double MeanOffset = 0.0;
+    for (const FExchange& E : Best)
+    {
+        MeanTime += E.LocalTime;
+        MeanOffset += E.Offset;
+    }
+    MeanTime /= Best.Num();
+    MeanOffset /= Best.Num();
+
+    double Sxx = 0.0;
+    double Sxy = 0.0;
+    for (const FExchange& E : Best)
+    {
+        Sxx += (E.LocalTime - MeanTime) * (E.LocalTime - MeanTime);
+        Sxy += (E.LocalTime - MeanTime) * (E.Offset - MeanOffset);
+    }
+
+    // Need a few seconds of spread before a slope means anything; cap at crystal-grade drift
+    const double Slope = (Sxx > 1.0) ? Sxy / Sxx : 0.0;
+    Drift = FMath::Clamp(Slope, -500e-6, 500e-6);
+    ReferenceTime = MeanTime;
+    Offset = MeanOffset;
+
+    double Residual = 0.0;
+    for (const FExchange& E : Best)
+    {
+        const double Error = E.Offset - (Offset + Drift * (E.LocalTime - ReferenceTime));
+        Residual += Error * Error;
+    }
+    Residual = FMath::Sqrt(Residual / Best.Num());
+
+    // Any offset within half the best round trip is consistent with the exchange
+    ErrorBound = Best[0].Delay * 0.5 + 2.0 * Residual;
+}
+
+double FVaroniaClockSync::ToServerTime(double LocalTime) const
+{
+    return LocalTime + Offset + Drift * (LocalTime - ReferenceTime);
+}
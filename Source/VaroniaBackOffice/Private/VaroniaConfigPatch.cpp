@@ -0,0 +1,132 @@
+#include "VaroniaConfigPatch.h"
+#include "VaroniaBackOfficeManager.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "JsonObjectConverter.h"
+
+bool FVaroniaConfigPatch::Parse(const TArray<uint8>& Payload, FVaroniaConfigPatch& OutPatch)
+{
+    FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Payload.GetData()), Payload.Num());
+    TSharedPtr<FJsonObject> Root;
+    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(FString(Text.Length(), Text.Get()));
+    if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid()) return false;
+
+    if (!Root->TryGetNumberField(TEXT("Version"), OutPatch.Version)) return false;
+
+    const TSharedPtr<FJsonObject>* Section = nullptr;
+    OutPatch.Config = Root->TryGetObjectField(TEXT("Config"), Section) ? *Section : nullptr;
+    OutPatch.Spatial = Root->TryGetObjectField(TEXT("Spatial"), Section) ? *Section : nullptr;
+    return true;
+}
+
+bool FVaroniaConfigPatch::ApplyConfig(FLBEConfig& InOutConfig, TArray<FName>& OutChanged, FString& OutError) const
+{
+    OutChanged.Reset();
+    if (!Config.IsValid()) return true;
+
+    const UScriptStruct* Struct = FLBEConfig::StaticStruct();
+    FLBEConfig Patched = InOutConfig;
+
+    for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Config->Values)
+    {
+        FProperty* Property = Struct->FindPropertyByName(*Field.Key);
+        if (!Property)
+        {
+            OutError = FString::Printf(TEXT("Unknown config field %s"), *Field.Key);
+            return false;
+        }
+
+        void* Value = Property->ContainerPtrToValuePtr<void>(&Patched);
+        if (!FJsonObjectConverter::JsonValueToUProperty(Field.Value, Property, Value, 0, 0))
+        {
+            OutError = FString::Printf(TEXT("Bad value for config field %s"), *Field.Key);
+            return false;
+        }
+
+        if (!Property->Identical(Value, Property->ContainerPtrToValuePtr<void>(&InOutConfig)))
+        {
+            OutChanged.Add(Property->GetFName());
+        }
+    }
+
+    InOutConfig = MoveTemp(Patched);
+    return true;
+}
+
+bool FVaroniaConfigPatch::ApplySpatial(const FJsonObject& SpatialPatch, FSpatialConfig& InOutConfig, FString& OutError)
+{
+    FSpatialConfig Patched = InOutConfig;
+
+    SpatialPatch.TryGetStringField(TEXT("Name"), Patched.Name);
+    SpatialPatch.TryGetStringField(TEXT("AreaValue"), Patched.AreaValue);
+    SpatialPatch.TryGetStringField(TEXT("MaxRect"), Patched.MaxRect);
+    SpatialPatch.TryGetStringField(TEXT("GroupName"), Patched.GroupName);
+    SpatialPatch.TryGetStringField(TEXT("OrthoKey"), Patched.OrthoKey);
+    SpatialPatch.TryGetNumberField(TEXT("MaxPlayer"), Patched.MaxPlayer);
+
+    double Multiplier = 0.0;
+    if (SpatialPatch.TryGetNumberField(TEXT("Multiplier"), Multiplier))
+    {
+        Patched.Multiplier = (float)Multiplier;
+    }
+
+    const TArray<TSharedPtr<FJsonValue>>* Removed = nullptr;
+    if (SpatialPatch.TryGetArrayField(TEXT("RemoveBoundaries"), Removed))
+    {
+        for (const TSharedPtr<FJsonValue>& ID : *Removed)
+        {
+            const FString BoundaryID = ID->AsString();
+            Patched.Boundaries.RemoveAll([&BoundaryID](const FSpatialBoundary& B) { return B.ID == BoundaryID; });
+        }
+    }
+
+    const TArray<TSharedPtr<FJsonValue>>* Boundaries = nullptr;
+    if (SpatialPatch.TryGetArrayField(TEXT("Boundaries"), Boundaries))
+    {
+        for (const TSharedPtr<FJsonValue>& BoundaryValue : *Boundaries)
+        {
+            const TSharedPtr<FJsonObject>* BObj = nullptr;
+            if (!BoundaryValue->TryGetObject(BObj) || !(*BObj)->HasTypedField<EJson::String>(TEXT("ID")))
+            {
+                OutError = TEXT("Spatial patch boundary without ID");
+                return false;
+            }
+
+            FSpatialBoundary Boundary;
+            UVaroniaBackOfficeManager::ParseSpatialBoundary(*BObj, Boundary);
+
+            if (FSpatialBoundary* Existing = Patched.Boundaries.FindByPredicate([&Boundary](const FSpatialBoundary& B) { return B.ID == Boundary.ID; }))
+            {
+                *Existing = MoveTemp(Boundary);
+            }
+            else
+            {
+                Patched.Boundaries.Add(MoveTemp(Boundary));
+            }
+        }
+    }
+
+    InOutConfig = MoveTemp(Patched);
+    return true;
+}
+
+bool FVaroniaConfigPatch::IsLaunchOnlyField(FName Field)
+{
+    return Field == GET_MEMBER_NAME_CHECKED(FLBEConfig, ServerIP)
+        || Field == GET_MEMBER_NAME_CHECKED(FLBEConfig, MQTT_ServerIP)
+        || Field == GET_MEMBER_NAME_CHECKED(FLBEConfig, MQTT_IDClient)
+        || Field == GET_MEMBER_NAME_CHECKED(FLBEConfig, DeviceMode);
+}
+
+TSharedPtr<FJsonValue> FVaroniaConfigPatch::ConfigFieldToJson(FName Field, const FLBEConfig& Config)
+{
+    const FProperty* Property = FLBEConfig::StaticStruct()->FindPropertyByName(Field);
+    if (!Property) return nullptr;
+
+    const void* Value = Property->ContainerPtrToValuePtr<void>(&Config);
+    if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+    {
+        return MakeShared<FJsonValueNumber>((double)EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(Value));
+    }
+    return FJsonObjectConverter::UPropertyToJsonValue(const_cast<FProperty*>(Property), Value, 0, 0);
+}
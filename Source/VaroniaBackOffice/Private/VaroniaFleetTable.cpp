@@ -0,0 +1,162 @@
+#include "VaroniaFleetTable.h"
+
+// ============================================================================
+// Slots
+// ============================================================================
+
+int32 FVaroniaFleetTable::FindSlot(int32 DeviceID) const
+{
+    return SlotOfDevice.IsValidIndex(DeviceID) ? SlotOfDevice[DeviceID] : INDEX_NONE;
+}
+
+int32 FVaroniaFleetTable::FindOrAddSlot(int32 DeviceID)
+{
+    if (DeviceID < 0 || DeviceID >= MaxDeviceID) return INDEX_NONE;
+
+    if (DeviceID >= SlotOfDevice.Num())
+    {
+        const int32 OldNum = SlotOfDevice.Num();
+        SlotOfDevice.SetNumUninitialized(FMath::Min(FMath::RoundUpToPowerOfTwo(DeviceID + 1), (uint32)MaxDeviceID));
+        for (int32 i = OldNum; i < SlotOfDevice.Num(); ++i) { SlotOfDevice[i] = INDEX_NONE; }
+    }
+
+    int32& Slot = SlotOfDevice[DeviceID];
+    if (Slot == INDEX_NONE)
+    {
+        Slot = DeviceIDs.Add(DeviceID);
+        SoftStates.Add(ESoftState::UNKNOWN);
+        LastSeen.Add(0.0);
+        PlayerNames.AddDefaulted();
+        Health.Add(EVaroniaDeviceHealth::Offline); // Until MarkSeen: a row may come from retained state only
+        Dirty.Add(false);
+        MarkDirty(Slot);
+    }
+    return Slot;
+}
+
+void FVaroniaFleetTable::MarkDirty(int32 Slot)
+{
+    Version++;
+    if (!Dirty[Slot])
+    {
+        Dirty[Slot] = true;
+        DirtySlots.Add(Slot);
+    }
+}
+
+void FVaroniaFleetTable::Reset()
+{
+    SlotOfDevice.Reset();
+    DeviceIDs.Reset();
+    SoftStates.Reset();
+    LastSeen.Reset();
+    PlayerNames.Reset();
+    Health.Reset();
+    Dirty.Reset();
+    DirtySlots.Reset();
+    Snapshot.Reset();
+    Version++;
+}
+
+// ============================================================================
+// Updates
+// ============================================================================
+
+void FVaroniaFleetTable::MarkSeen(int32 DeviceID, double Now)
+{
+    const int32 Slot = FindOrAddSlot(DeviceID);
+    if (Slot == INDEX_NONE) return;
+
+    // Last-seen alone moves every message; only health flips are worth a notification
+    LastSeen[Slot] = Now;
+    Version++;
+    if (Health[Slot] != EVaroniaDeviceHealth::Online)
+    {
+        Health[Slot] = EVaroniaDeviceHealth::Online;
+        MarkDirty(Slot);
+    }
+}
+
+void FVaroniaFleetTable::SetSoftState(int32 DeviceID, ESoftState State)
+{
+    const int32 Slot = FindOrAddSlot(DeviceID);
+    if (Slot == INDEX_NONE || SoftStates[Slot] == State) return;
+
+    SoftStates[Slot] = State;
+    MarkDirty(Slot);
+}
+
+void FVaroniaFleetTable::SetPlayerName(int32 DeviceID, const FString& PlayerName)
+{
+    const int32 Slot = FindOrAddSlot(DeviceID);
+    if (Slot == INDEX_NONE || PlayerNames[Slot] == PlayerName) return;
+
+    PlayerNames[Slot] = PlayerName;
+    MarkDirty(Slot);
+}
+
+void FVaroniaFleetTable::UpdateHealth(double Now)
+{
+    for (int32 Slot = 0; Slot < DeviceIDs.Num(); ++Slot)
+    {
+        const double Silence = Now - LastSeen[Slot];
+        const EVaroniaDeviceHealth NewHealth =
+            Silence >= OfflineAfter ? EVaroniaDeviceHealth::Offline :
+            Silence >= StaleAfter ? EVaroniaDeviceHealth::Stale :
+            EVaroniaDeviceHealth::Online;
+
+        if (Health[Slot] != NewHealth)
+        {
+            Health[Slot] = NewHealth;
+            MarkDirty(Slot);
+        }
+    }
+}
+
+// ============================================================================
+// Readers
+// ============================================================================
+
+bool FVaroniaFleetTable::ConsumeChanges(TArray<int32>& OutDeviceIDs)
+{
+    OutDeviceIDs.Reset(DirtySlots.Num());
+    for (int32 Slot : DirtySlots)
+    {
+        OutDeviceIDs.Add(DeviceIDs[Slot]);
+        Dirty[Slot] = false;
+    }
+    DirtySlots.Reset();
+    return OutDeviceIDs.Num() > 0;
+}
+
+const TArray<FVaroniaFleetEntry>& FVaroniaFleetTable::GetSnapshot()
+{
+    if (SnapshotVersion != Version)
+    {
+        Snapshot.SetNum(DeviceIDs.Num());
+        for (int32 Slot = 0; Slot < DeviceIDs.Num(); ++Slot)
+        {
+            FVaroniaFleetEntry& Entry = Snapshot[Slot];
+            Entry.DeviceID = DeviceIDs[Slot];
+            Entry.SoftState = SoftStates[Slot];
+            Entry.LastSeen = LastSeen[Slot];
+            Entry.PlayerName = PlayerNames[Slot];
+            Entry.Health = Health[Slot];
+        }
+        SnapshotVersion = Version;
+    }
+    return Snapshot;
+}
+
+bool FVaroniaFleetTable::GetEntry(int32 DeviceID, FVaroniaFleetEntry& OutEntry) const
+{
+    const int32 Slot = FindSlot(DeviceID);
+    if (Slot == INDEX_NONE) return false;
+
+    OutEntry.DeviceID = DeviceID;
+    OutEntry.SoftState = SoftStates[Slot];
+    OutEntry.LastSeen = LastSeen[Slot];
+    OutEntry.PlayerName = PlayerNames[Slot];
+    OutEntry.Health = Health[Slot];
+    return true;
+}
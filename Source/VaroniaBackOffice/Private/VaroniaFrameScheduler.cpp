@@ -0,0 +1,105 @@
+#include "VaroniaFrameScheduler.h"
+#include "VaroniaStats.h"
+
+int32 FVaroniaFrameScheduler::AddTask(const TCHAR* Name, EVaroniaTaskPriority Priority, float EstimatedCostUs, FTaskFunction Function)
+{
+    // Adding while Run is iterating could reallocate Tasks under the running task
+    FTask& Task = bRunning ? PendingAdds.AddDefaulted_GetRef() : Tasks.AddDefaulted_GetRef();
+    Task.Handle = NextHandle++;
+    Task.Name = Name;
+    Task.Priority = Priority;
+    Task.CostUs = EstimatedCostUs;
+    Task.Function = MoveTemp(Function);
+    return Task.Handle;
+}
+
+void FVaroniaFrameScheduler::RemoveTask(int32 Handle)
+{
+    // Tasks may unregister themselves (or others) from inside Run
+    if (bRunning)
+    {
+        PendingRemovals.Add(Handle);
+        return;
+    }
+    Tasks.RemoveAll([Handle](const FTask& Task) { return Task.Handle == Handle; });
+}
+
+void FVaroniaFrameScheduler::Run()
+{
+    VARONIA_SCOPE_STAT(Scheduler);
+
+    // Effective priority = base level minus aging; ties keep registration order
+    Order.Reset(Tasks.Num());
+    for (int32 i = 0; i < Tasks.Num(); ++i)
+    {
+        Order.Add(i);
+    }
+    const int32 Aging = FMath::Max(AgingFrames, 1);
+    Order.StableSort([this, Aging](int32 A, int32 B)
+    {
+        return (int32)Tasks[A].Priority - Tasks[A].FramesDeferred / Aging
+             < (int32)Tasks[B].Priority - Tasks[B].FramesDeferred / Aging;
+    });
+
+    const double FrameStart = FPlatformTime::Seconds();
+    const double FrameEnd = FrameStart + BudgetUs * 1e-6;
+    double UsedUs = 0.0;
+    int32 Ran = 0;
+    int32 Deferred = 0;
+
+    bRunning = true;
+    for (int32 Index : Order)
+    {
+        FTask& Task = Tasks[Index];
+
+        const bool bFits = UsedUs + Task.CostUs <= BudgetUs;
+        if (!bFits && Task.Priority != EVaroniaTaskPriority::Critical && Task.FramesDeferred < MaxDeferFrames)
+        {
+            ++Task.FramesDeferred;
+            ++Deferred;
+            continue;
+        }
+
+        TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(Task.Name);
+
+        const double Start = FPlatformTime::Seconds();
+        const bool bKeep = Task.Function(FMath::Max(FrameEnd, Start + Task.CostUs * 1e-6));
+        const double ElapsedUs = (FPlatformTime::Seconds() - Start) * 1e6;
+
+        // Fast to follow a slow frame, slow to forget one
+        Task.CostUs = ElapsedUs > Task.CostUs
+            ? (float)ElapsedUs
+            : FMath::Lerp(Task.CostUs, (float)ElapsedUs, 0.1f);
+        Task.FramesDeferred = 0;
+        UsedUs += ElapsedUs;
+        ++Ran;
+
+        if (!bKeep)
+        {
+            PendingRemovals.Add(Task.Handle);
+        }
+    }
+    bRunning = false;
+
+    Tasks.Append(MoveTemp(PendingAdds));
+    PendingAdds.Reset();
+
+    for (int32 Handle : PendingRemovals)
+    {
+        RemoveTask(Handle);
+    }
+    PendingRemovals.Reset();
+
+    Stats.LastFrameUs = (float)UsedUs;
+    Stats.LastFrameRan = Ran;
+    Stats.LastFrameDeferred = Deferred;
+    Stats.TotalDeferred += Deferred;
+    if (UsedUs > BudgetUs)
+    {
+        ++Stats.TotalOverruns;
+    }
+
+    SET_DWORD_STAT(STAT_Varonia_SchedulerDeferred, Deferred);
+    CSV_CUSTOM_STAT(Varonia, SchedulerDeferred, Deferred, ECsvCustomStatOp::Set);
+    CSV_CUSTOM_STAT(Varonia, SchedulerUs, (float)UsedUs, ECsvCustomStatOp::Set);
+}
@@ -0,0 +1,116 @@
+#include "VaroniaInitGraph.h"
+#include "VaroniaBackOfficeManager.h"
+#include "VaroniaTrace.h"
+#include "Algo/AllOf.h"
+
+void FVaroniaInitGraph::AddStep(const TCHAR* Name, TArray<const TCHAR*> Dependencies, EVaroniaInitThread Thread, TFunction<void()> Work)
+{
+    FStep& Step = Steps.AddDefaulted_GetRef();
+    Step.Name = Name;
+    Step.Thread = Thread;
+    Step.Work = MoveTemp(Work);
+
+    for (const TCHAR* Dependency : Dependencies)
+    {
+        const int32 Index = Steps.IndexOfByPredicate([Dependency](const FStep& Other) { return FCString::Strcmp(Other.Name, Dependency) == 0; });
+        checkf(Index != INDEX_NONE && Index < Steps.Num() - 1, TEXT("Init step %s depends on unknown step %s"), Name, Dependency);
+        Step.Dependencies.Add(Index);
+    }
+}
+
+void FVaroniaInitGraph::Execute(FStep& Step)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(Step.Name, VaroniaChannel);
+
+    Step.Start = FPlatformTime::Seconds();
+    Step.Work();
+    Step.End = FPlatformTime::Seconds();
+
+    FVaroniaStartupTrace::Get().AddSpan(Step.Name, Step.Start, Step.End);
+}
+
+void FVaroniaInitGraph::Run()
+{
+    RunStart = FPlatformTime::Seconds();
+
+    // Real task handles, not events: waiting on a task that has not started yet runs it inline,
+    // so the game thread never stalls behind busy (or missing) workers. A finished game-thread
+    // step keeps an empty handle, which counts as done.
+    TArray<UE::Tasks::FTask> Tasks;
+    Tasks.SetNum(Steps.Num());
+    TArray<bool> Started;
+    Started.SetNumZeroed(Steps.Num());
+
+    auto Prerequisites = [this, &Tasks](const FStep& Step)
+    {
+        TArray<UE::Tasks::FTask> Result;
+        for (int32 Dependency : Step.Dependencies) { Result.Add(Tasks[Dependency]); }
+        return Result;
+    };
+
+    // Worker steps are launched once every dependency is launched or done; insertion order is topological
+    auto LaunchReady = [this, &Tasks, &Started, &Prerequisites]()
+    {
+        for (int32 i = 0; i < Steps.Num(); ++i)
+        {
+            if (Started[i] || Steps[i].Thread != EVaroniaInitThread::Worker) continue;
+            if (!Algo::AllOf(Steps[i].Dependencies, [&Started](int32 Dependency) { return Started[Dependency]; })) continue;
+
+            Tasks[i] = UE::Tasks::Launch(Steps[i].Name, [this, i]() { Execute(Steps[i]); }, Prerequisites(Steps[i]));
+            Started[i] = true;
+        }
+    };
+
+    LaunchReady();
+
+    // Game-thread steps in insertion order, each waiting only for its own dependencies
+    for (int32 i = 0; i < Steps.Num(); ++i)
+    {
+        if (Steps[i].Thread != EVaroniaInitThread::GameThread) continue;
+
+        UE::Tasks::Wait(Prerequisites(Steps[i]));
+        Execute(Steps[i]);
+        Started[i] = true;
+        LaunchReady();
+    }
+
+    UE::Tasks::Wait(Tasks);
+    RunEnd = FPlatformTime::Seconds();
+}
+
+void FVaroniaInitGraph::LogReport() const
+{
+    // Earliest possible finish of each step with unlimited parallelism
+    TArray<double> Finish;
+    TArray<int32> Via;
+    Finish.SetNumZeroed(Steps.Num());
+    Via.Init(INDEX_NONE, Steps.Num());
+
+    double SerialTime = 0.0;
+    int32 Last = INDEX_NONE;
+    for (int32 i = 0; i < Steps.Num(); ++i)
+    {
+        double Ready = 0.0;
+        for (int32 Dependency : Steps[i].Dependencies)
+        {
+            if (Finish[Dependency] > Ready) { Ready = Finish[Dependency]; Via[i] = Dependency; }
+        }
+
+        const double Duration = Steps[i].End - Steps[i].Start;
+        Finish[i] = Ready + Duration;
+        SerialTime += Duration;
+
+        if (Last == INDEX_NONE || Finish[i] > Finish[Last]) { Last = i; }
+    }
+
+    FString Path;
+    for (int32 i = Last; i != INDEX_NONE; i = Via[i])
+    {
+        const FString Node = FString::Printf(TEXT("%s (%.2f ms)"), Steps[i].Name, (Steps[i].End - Steps[i].Start) * 1000.0);
+        Path = Path.IsEmpty() ? Node : Node + TEXT(" -> ") + Path;
+    }
+
+    UE_LOG(LogVaronia, Log, TEXT("Init graph: wall %.2f ms, serial %.2f ms, critical path %.2f ms"),
+        (RunEnd - RunStart) * 1000.0, SerialTime * 1000.0, Last != INDEX_NONE ? Finish[Last] * 1000.0 : 0.0);
+    UE_LOG(LogVaronia, Log, TEXT("  Critical path: %s"), *Path);
+}
@@ -0,0 +1,249 @@
+#include "VaroniaJournal.h"
+#include "VaroniaBackOfficeManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+FVaroniaJournal& FVaroniaJournal::Get()
+{
+    static FVaroniaJournal Instance;
+    return Instance;
+}
+
+// ============================================================================
+// Lifetime
+// ============================================================================
+
+void FVaroniaJournal::Start(const FString& InDirectory)
+{
+    if (Thread) return;
+
+    Directory = InDirectory;
+    StartCycles = FPlatformTime::Cycles64();
+    OpenFile();
+    if (!File.IsValid())
+    {
+        UE_LOG(LogVaronia, Warning, TEXT("Event journal disabled: cannot write to %s"), *Directory);
+        return;
+    }
+
+    bStopping = false;
+    WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    Thread = FRunnableThread::Create(this, TEXT("VaroniaJournal"), 0, TPri_BelowNormal);
+    bEnabled = true;
+
+    Record(EVaroniaJournalEvent::JournalStarted, FPlatformProcess::GetCurrentProcessId());
+}
+
+void FVaroniaJournal::Stop()
+{
+    if (!Thread) return;
+
+    bEnabled = false;
+    bStopping = true;
+    WakeEvent->Trigger();
+    Thread->WaitForCompletion();
+    delete Thread;
+    Thread = nullptr;
+
+    FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+    WakeEvent = nullptr;
+
+    // Thread rings stay allocated: their owners may still hold them through the thread-local pointer
+    Drain();
+    File.Reset();
+}
+
+// ============================================================================
+// Producer side
+// ============================================================================
+
+FVaroniaJournal::FThreadRing* FVaroniaJournal::GetThreadRing()
+{
+    static thread_local FThreadRing* Ring = nullptr;
+    if (!Ring)
+    {
+        FScopeLock ScopeLock(&RingsLock);
+        Ring = Rings.Add_GetRef(MakeUnique<FThreadRing>()).Get();
+    }
+    return Ring;
+}
+
+void FVaroniaJournal::Record(EVaroniaJournalEvent Event, int64 A, int64 B)
+{
+    if (!bEnabled.load(std::memory_order_relaxed)) return;
+
+    FThreadRing* Ring = GetThreadRing();
+    const uint32 Head = Ring->Head.load(std::memory_order_relaxed);
+    if (Head - Ring->Tail.load(std::memory_order_acquire) >= RingSize)
+    {
+        Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    FVaroniaJournalRecord& Slot = Ring->Records[Head % RingSize];
+    Slot.TimeUs = (uint64)(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) * 1e6);
+    Slot.ThreadId = FPlatformTLS::GetCurrentThreadId();
+    Slot.Event = (uint16)Event;
+    Slot.A = A;
+    Slot.B = B;
+
+    Ring->Head.store(Head + 1, std::memory_order_release);
+}
+
+// ============================================================================
+// Flush thread
+// ============================================================================
+
+uint32 FVaroniaJournal::Run()
+{
+    while (!bStopping)
+    {
+        WakeEvent->Wait(100);
+        Drain();
+    }
+    return 0;
+}
+
+void FVaroniaJournal::Drain()
+{
+    Block.Reset();
+    {
+        FScopeLock ScopeLock(&RingsLock);
+        for (const TUniquePtr<FThreadRing>& Ring : Rings)
+        {
+            const uint32 Head = Ring->Head.load(std::memory_order_acquire);
+            uint32 Tail = Ring->Tail.load(std::memory_order_relaxed);
+            for (; Tail != Head; ++Tail)
+            {
+                Block.Add(Ring->Records[Tail % RingSize]);
+            }
+            Ring->Tail.store(Tail, std::memory_order_release);
+        }
+    }
+
+    if (Block.Num() == 0 || !File.IsValid()) return;
+
+    // Rings are drained one after the other; keep the file in time order (stable: one thread's
+    // records can share a microsecond)
+    Block.StableSort([](const FVaroniaJournalRecord& L, const FVaroniaJournalRecord& R) { return L.TimeUs < R.TimeUs; });
+    File->Serialize(Block.GetData(), Block.Num() * sizeof(FVaroniaJournalRecord));
+    File->Flush();
+
+    if (File->Tell() >= MaxFileBytes)
+    {
+        OpenFile();
+    }
+}
+
+void FVaroniaJournal::OpenFile()
+{
+    File.Reset();
+
+    IFileManager& FileManager = IFileManager::Get();
+    auto FilePath = [this](int32 Index)
+    {
+        return Index == 0
+            ? Directory / TEXT("Journal.vjl")
+            : Directory / FString::Printf(TEXT("Journal.%d.vjl"), Index);
+    };
+
+    // Journal.vjl -> Journal.1.vjl -> ... oldest dropped
+    FileManager.Delete(*FilePath(MaxFiles - 1), false, false, true);
+    for (int32 Index = MaxFiles - 2; Index >= 0; --Index)
+    {
+        if (FileManager.FileExists(*FilePath(Index)))
+        {
+            FileManager.Move(*FilePath(Index + 1), *FilePath(Index));
+        }
+    }
+
+    File.Reset(FileManager.CreateFileWriter(*FilePath(0)));
+    if (!File.IsValid()) return;
+
+    // Start time of this file, matching TimeUs = 0 of the records' clock
+    const double Elapsed = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+    uint32 HeaderMagic = Magic;
+    uint16 HeaderVersion = Version;
+    uint16 RecordSize = sizeof(FVaroniaJournalRecord);
+    int64 StartTicks = (FDateTime::UtcNow() - FTimespan::FromSeconds(Elapsed)).GetTicks();
+    *File << HeaderMagic << HeaderVersion << RecordSize << StartTicks;
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+bool FVaroniaJournal::ReadFile(const FString& Path, FDateTime& OutStart, TArray<FVaroniaJournalRecord>& OutRecords)
+{
+    TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+    if (!Reader.IsValid()) return false;
+
+    uint32 HeaderMagic = 0;
+    uint16 HeaderVersion = 0;
+    uint16 RecordSize = 0;
+    int64 StartTicks = 0;
+    *Reader << HeaderMagic << HeaderVersion << RecordSize << StartTicks;
+    if (HeaderMagic != Magic || HeaderVersion != Version || RecordSize != sizeof(FVaroniaJournalRecord)) return false;
+
+    // A crash can leave a partial record at the end
+    const int64 Count = (Reader->TotalSize() - Reader->Tell()) / RecordSize;
+    OutRecords.SetNumUninitialized(Count);
+    Reader->Serialize(OutRecords.GetData(), Count * RecordSize);
+    OutStart = FDateTime(StartTicks);
+    return !Reader->IsError();
+}
+
+FString FVaroniaJournal::Describe(const FVaroniaJournalRecord& Record)
+{
+    switch ((EVaroniaJournalEvent)Record.Event)
+    {
+    case EVaroniaJournalEvent::JournalStarted:      return FString::Printf(TEXT("Journal started (pid %lld)"), Record.A);
+    case EVaroniaJournalEvent::ConfigLoaded:        return FString::Printf(TEXT("Config loaded (ID %lld, %s)"), Record.A,
+                                                        *StaticEnum<EDeviceMode>()->GetNameStringByValue(Record.B));
+    case EVaroniaJournalEvent::ConfigDefaulted:     return TEXT("Config missing, defaults written");
+    case EVaroniaJournalEvent::ConfigPatched:       return FString::Printf(TEXT("Config patch v%lld (%lld fields)"), Record.A, Record.B);
+    case EVaroniaJournalEvent::SpatialLoaded:       return FString::Printf(TEXT("Spatial loaded (%lld boundaries)"), Record.A);
+    case EVaroniaJournalEvent::SoftStateChanged:    return FString::Printf(TEXT("SoftState %s -> %s"),
+                                                        *StaticEnum<ESoftState>()->GetNameStringByValue(Record.A),
+                                                        *StaticEnum<ESoftState>()->GetNameStringByValue(Record.B));
+    case EVaroniaJournalEvent::SoftStateRejected:   return FString::Printf(TEXT("SoftState %s -> %s rejected"),
+                                                        *StaticEnum<ESoftState>()->GetNameStringByValue(Record.A),
+                                                        *StaticEnum<ESoftState>()->GetNameStringByValue(Record.B));
+    case EVaroniaJournalEvent::MqttConnecting:      return FString::Printf(TEXT("MQTT connecting (ID %lld, port %lld)"), Record.A, Record.B);
+    case EVaroniaJournalEvent::MqttConnected:       return FString::Printf(TEXT("MQTT connected (%.1f ms)"), Record.A / 1000.0);
+    case EVaroniaJournalEvent::MqttDisconnected:    return TEXT("MQTT disconnected");
+    case EVaroniaJournalEvent::MqttError:           return FString::Printf(TEXT("MQTT error %lld"), Record.A);
+    case EVaroniaJournalEvent::ClockSynced:         return FString::Printf(TEXT("Clock synced (+-%.2f ms, %.1f ppm)"), Record.A / 1000.0, Record.B / 1000.0);
+    case EVaroniaJournalEvent::DeviceHealthChanged: return FString::Printf(TEXT("Device %lld health %s"), Record.A,
+                                                        *StaticEnum<EVaroniaDeviceHealth>()->GetNameStringByValue(Record.B));
+    case EVaroniaJournalEvent::SpawnTimedOut:       return FString::Printf(TEXT("BP_Varonia spawn timed out (%lld ms)"), Record.A);
+    case EVaroniaJournalEvent::BoundaryEntered:     return FString::Printf(TEXT("Device %lld entered boundary %lld"), Record.A, Record.B);
+    case EVaroniaJournalEvent::BoundaryExited:      return FString::Printf(TEXT("Device %lld left boundary %lld"), Record.A, Record.B);
+    default:                                        return FString::Printf(TEXT("Event %u (%lld, %lld)"), Record.Event, Record.A, Record.B);
+    }
+}
+
+static FAutoConsoleCommand DumpJournalCommand(
+    TEXT("Varonia.Journal.Dump"),
+    TEXT("Print a Varonia event journal to the log. Varonia.Journal.Dump [Path] (default: current journal)"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        const FString Path = Args.Num() > 0 ? Args[0] : FPaths::ProjectLogDir() / TEXT("Varonia/Journal.vjl");
+
+        FDateTime Start;
+        TArray<FVaroniaJournalRecord> Records;
+        if (!FVaroniaJournal::ReadFile(Path, Start, Records))
+        {
+            UE_LOG(LogVaronia, Error, TEXT("%s is not a readable Varonia journal"), *Path);
+            return;
+        }
+
+        UE_LOG(LogVaronia, Display, TEXT("%s: %d records since %s UTC"), *Path, Records.Num(), *Start.ToString());
+        for (const FVaroniaJournalRecord& Record : Records)
+        {
+            const FDateTime Time = Start + FTimespan::FromMicroseconds((double)Record.TimeUs);
+            UE_LOG(LogVaronia, Display, TEXT("  %s  [%5u] %s"), *Time.ToString(TEXT("%H:%M:%S.%s")), Record.ThreadId, *FVaroniaJournal::Describe(Record));
+        }
+    }));
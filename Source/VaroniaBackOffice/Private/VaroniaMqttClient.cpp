@@ -1,10 +1,15 @@
 #include "VaroniaMqttClient.h"
 #include "MqttUtilitiesBPL.h"
+#include "VaroniaTrace.h"
+#include "VaroniaStats.h"
+#include "VaroniaJournal.h"
+#include "Misc/Paths.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogVaroniaMqtt, Log, All);
 
 void UVaroniaMqttClient::Connect(const FString& Host, int32 Port, int32 InClientID)
 {
+    VARONIA_TRACE_SCOPE("Mqtt.Connect");
 
     ClientID = InClientID;
 
@@ -33,6 +38,11 @@ void UVaroniaMqttClient::Connect(const FString& Host, int32 Port, int32 InClient
     OnErrorDelegate.BindDynamic(this, &UVaroniaMqttClient::HandleError);
     MqttClient->SetOnErrorHandler(OnErrorDelegate);
 
+    // Messages
+    FOnMessageDelegate OnMessageDelegate;
+    OnMessageDelegate.BindDynamic(this, &UVaroniaMqttClient::HandleMessage);
+    MqttClient->SetOnMessageHandler(OnMessageDelegate);
+
     // Connect
     FOnConnectDelegate OnConnectDelegate;
     OnConnectDelegate.BindDynamic(this, &UVaroniaMqttClient::HandleConnected);
@@ -41,9 +51,11 @@ void UVaroniaMqttClient::Connect(const FString& Host, int32 Port, int32 InClient
     ConnectionData.Login = TEXT("");
     ConnectionData.Password = TEXT("");
 
+    ConnectStartTime = FPlatformTime::Seconds();
     MqttClient->Connect(ConnectionData, OnConnectDelegate);
 
-    UE_LOG(LogVaroniaMqtt, Log, TEXT("MQTT connecting to %s:%d (ID: %s)..."),
+    VARONIA_JOURNAL(MqttConnecting, ClientID, Port);
+    UE_LOG(LogVaroniaMqtt, Verbose, TEXT("MQTT connecting to %s:%d (ID: %s)..."),
         *Host, Port, *Config.ClientId);
 }
 
@@ -56,10 +68,76 @@ void UVaroniaMqttClient::Disconnect()
     MqttClient->Disconnect(OnDisconnectDelegate);
 }
 
+void UVaroniaMqttClient::Subscribe(const FString& Topic, int32 Qos)
+{
+    Subscriptions.Add(Topic, Qos);
+
+    if (bIsConnected && MqttClient.GetObject())
+    {
+        MqttClient->Subscribe(Topic, Qos);
+    }
+}
+
+void UVaroniaMqttClient::Publish(const FString& Topic, const FString& Message, int32 Qos, bool bRetain)
+{
+    if (!bIsConnected || !MqttClient.GetObject()) return;
+
+    VARONIA_SCOPE_STAT(MqttSend);
+    VARONIA_COUNT_MESSAGE(MessagesSent);
+
+    FMqttMessage MqttMessage;
+    MqttMessage.Topic = Topic;
+    MqttMessage.Message = Message;
+    MqttMessage.Qos = Qos;
+    MqttMessage.Retain = bRetain;
+    MqttClient->Publish(MqttMessage);
+
+    if (Recorder.IsValid())
+    {
+        FTCHARToUTF8 Utf8(*Message);
+        Recorder->Record(EVaroniaMqttDirection::Outbound, Topic,
+            TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length()));
+    }
+}
+
+void UVaroniaMqttClient::PublishBytes(const FString& Topic, const TArray<uint8>& Payload, int32 Qos, bool bRetain)
+{
+    if (!bIsConnected || !MqttClient.GetObject()) return;
+
+    VARONIA_SCOPE_STAT(MqttSend);
+    VARONIA_COUNT_MESSAGE(MessagesSent);
+
+    FMqttMessage MqttMessage;
+    MqttMessage.Topic = Topic;
+    MqttMessage.MessageBuffer = Payload;
+    MqttMessage.Qos = Qos;
+    MqttMessage.Retain = bRetain;
+    MqttClient->Publish(MqttMessage);
+
+    if (Recorder.IsValid())
+    {
+        Recorder->Record(EVaroniaMqttDirection::Outbound, Topic, Payload);
+    }
+}
+
 void UVaroniaMqttClient::HandleConnected()
 {
     bIsConnected = true;
+    VARONIA_JOURNAL(MqttConnected, (int64)((FPlatformTime::Seconds() - ConnectStartTime) * 1e6));
     UE_LOG(LogVaroniaMqtt, Log, TEXT("MQTT Connected!"));
+    FVaroniaStartupTrace::Get().AddSpan(TEXT("Mqtt.BrokerHandshake"), ConnectStartTime, FPlatformTime::Seconds());
+
+    for (const TPair<FString, int32>& Sub : Subscriptions)
+    {
+        MqttClient->Subscribe(Sub.Key, Sub.Value);
+    }
+
+    // Whatever the broker saw before is gone for new subscribers
+    for (TPair<FString, TUniquePtr<FVaroniaStructReplicator>>& Replicator : ReplicatedStructs)
+    {
+        Replicator.Value->MarkAllDirty();
+    }
+
     OnConnected.Broadcast();
 }
 
@@ -67,12 +145,216 @@ void UVaroniaMqttClient::HandleDisconnected()
 {
     bIsConnected = false;
     MqttClient = nullptr;
+    VARONIA_JOURNAL(MqttDisconnected);
     UE_LOG(LogVaroniaMqtt, Log, TEXT("MQTT Disconnected"));
     OnDisconnected.Broadcast();
 }
 
 void UVaroniaMqttClient::HandleError(int Code, FString Message)
 {
+    VARONIA_JOURNAL(MqttError, Code);
     UE_LOG(LogVaroniaMqtt, Error, TEXT("MQTT Error %d: %s"), Code, *Message);
     OnError.Broadcast(Code, Message);
+}
+
+void UVaroniaMqttClient::HandleMessage(FMqttMessage Message)
+{
+    // Binary publishers only fill MessageBuffer, text publishers may only fill Message
+    if (Message.MessageBuffer.Num() == 0 && !Message.Message.IsEmpty())
+    {
+        FTCHARToUTF8 Utf8(*Message.Message);
+        Message.MessageBuffer.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+    }
+
+    if (Recorder.IsValid())
+    {
+        Recorder->Record(EVaroniaMqttDirection::Inbound, Message.Topic, Message.MessageBuffer);
+    }
+
+    DispatchMessage(Message.Topic, Message.MessageBuffer, Message.Message);
+}
+
+void UVaroniaMqttClient::DispatchMessage(const FString& Topic, const TArray<uint8>& Payload, const FString& Text)
+{
+    VARONIA_SCOPE_STAT(MqttReceive);
+    VARONIA_COUNT_MESSAGE(MessagesReceived);
+
+    if (Topic.StartsWith(VaroniaMqttTopics::State))
+    {
+        HandleStateMessage(Topic, Payload);
+    }
+
+    OnMessageNative.Broadcast(Topic, Payload);
+
+    if (OnMessage.IsBound())
+    {
+        if (Text.IsEmpty() && Payload.Num() > 0)
+        {
+            FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Payload.GetData()), Payload.Num());
+            OnMessage.Broadcast(Topic, FString(Converted.Length(), Converted.Get()));
+        }
+        else
+        {
+            OnMessage.Broadcast(Topic, Text);
+        }
+    }
+}
+
+// ============================================================================
+// Record / replay
+// ============================================================================
+
+bool UVaroniaMqttClient::StartRecording(const FString& Path)
+{
+    const FString FilePath = Path.IsEmpty()
+        ? FPaths::ProjectSavedDir() / TEXT("Varonia/Sessions") / FDateTime::Now().ToString() + TEXT(".vmqr")
+        : Path;
+
+    Recorder = MakeUnique<FVaroniaMqttRecorder>();
+    if (!Recorder->Open(FilePath))
+    {
+        Recorder.Reset();
+        return false;
+    }
+
+    UE_LOG(LogVaroniaMqtt, Log, TEXT("Recording MQTT session to %s"), *FilePath);
+    return true;
+}
+
+void UVaroniaMqttClient::StopRecording()
+{
+    if (!Recorder.IsValid()) return;
+
+    Recorder->Close();
+    Recorder.Reset();
+    UE_LOG(LogVaroniaMqtt, Log, TEXT("MQTT recording stopped"));
+}
+
+bool UVaroniaMqttClient::StartReplay(const FString& Path, float Speed, bool bPublishOutbound)
+{
+    StopReplay();
+
+    Replayer = MakeUnique<FVaroniaMqttReplayer>();
+    if (!Replayer->Open(Path, Speed))
+    {
+        Replayer.Reset();
+        return false;
+    }
+
+    bReplayOutbound = bPublishOutbound;
+    ReplayTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+        FTickerDelegate::CreateUObject(this, &UVaroniaMqttClient::TickReplay));
+
+    UE_LOG(LogVaroniaMqtt, Log, TEXT("Replaying MQTT session %s (x%.1f)"), *Path, Speed);
+    return true;
+}
+
+void UVaroniaMqttClient::StopReplay()
+{
+    if (ReplayTickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(ReplayTickerHandle);
+        ReplayTickerHandle.Reset();
+    }
+    Replayer.Reset();
+}
+
+bool UVaroniaMqttClient::TickReplay(float DeltaTime)
+{
+    const bool bMore = Replayer->Tick(FPlatformTime::Seconds(),
+        [this](EVaroniaMqttDirection Direction, const FString& Topic, const TArray<uint8>& Payload)
+        {
+            if (Direction == EVaroniaMqttDirection::Inbound)
+            {
+                DispatchMessage(Topic, Payload, FString());
+            }
+            else if (bReplayOutbound)
+            {
+                PublishBytes(Topic, Payload);
+            }
+        });
+
+    if (!bMore)
+    {
+        UE_LOG(LogVaroniaMqtt, Log, TEXT("MQTT replay finished"));
+        ReplayTickerHandle.Reset();
+        Replayer.Reset();
+    }
+    return bMore;
+}
+
+void UVaroniaMqttClient::BeginDestroy()
+{
+    StopReplay();
+    StopRecording();
+    Super::BeginDestroy();
+}
+
+// ============================================================================
+// Struct replication
+// ============================================================================
+
+void UVaroniaMqttClient::RegisterReplicatedStruct(const FString& Channel, const UScriptStruct* Struct, float MaxRateHz)
+{
+    check(Struct);
+    ReplicatedStructs.Add(Channel, MakeUnique<FVaroniaStructReplicator>(Struct, MaxRateHz));
+}
+
+void UVaroniaMqttClient::UpdateReplicatedStruct(const FString& Channel, const void* Data)
+{
+    if (TUniquePtr<FVaroniaStructReplicator>* Replicator = ReplicatedStructs.Find(Channel))
+    {
+        (*Replicator)->Update(Data);
+    }
+}
+
+void UVaroniaMqttClient::MirrorReplicatedStruct(const FString& Channel, const UScriptStruct* Struct)
+{
+    check(Struct);
+    MirroredStructs.FindOrAdd(Channel).Struct = Struct;
+    Subscribe(FString::Printf(TEXT("%s/%s/+"), VaroniaMqttTopics::State, *Channel), 1);
+}
+
+const void* UVaroniaMqttClient::GetMirroredStruct(const FString& Channel, int32 DeviceID) const
+{
+    const FMirrorChannel* Mirror = MirroredStructs.Find(Channel);
+    if (!Mirror) return nullptr;
+
+    const TUniquePtr<FVaroniaStructMirror>* Device = Mirror->Devices.Find(DeviceID);
+    return Device ? (*Device)->GetData() : nullptr;
+}
+
+void UVaroniaMqttClient::TickReplication(double Now)
+{
+    if (!bIsConnected) return;
+
+    FString Message;
+    for (TPair<FString, TUniquePtr<FVaroniaStructReplicator>>& Replicator : ReplicatedStructs)
+    {
+        if (Replicator.Value->BuildDelta(Now, Message))
+        {
+            Publish(FString::Printf(TEXT("%s/%s/%d"), VaroniaMqttTopics::State, *Replicator.Key, ClientID), Message, 1);
+        }
+    }
+}
+
+void UVaroniaMqttClient::HandleStateMessage(const FString& Topic, const TArray<uint8>& Payload)
+{
+    // Varonia/State/<Channel>/<DeviceID>
+    TArray<FString> Parts;
+    Topic.ParseIntoArray(Parts, TEXT("/"));
+    if (Parts.Num() != 4) return;
+
+    FMirrorChannel* Mirror = MirroredStructs.Find(Parts[2]);
+    if (!Mirror) return;
+
+    const int32 DeviceID = FCString::Atoi(*Parts[3]);
+    TUniquePtr<FVaroniaStructMirror>& Device = Mirror->Devices.FindOrAdd(DeviceID);
+    if (!Device.IsValid())
+    {
+        Device = MakeUnique<FVaroniaStructMirror>(Mirror->Struct);
+    }
+
+    FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Payload.GetData()), Payload.Num());
+    Device->ApplyDelta(FString(Text.Length(), Text.Get()));
 }
\ No newline at end of file
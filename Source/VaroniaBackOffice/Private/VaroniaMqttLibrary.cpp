@@ -1,9 +1,13 @@
 #include "VaroniaMqttLibrary.h"
 #include "Dom/JsonObject.h"
 #include "Serialization/JsonSerializer.h"
+#include "JsonObjectConverter.h"
+#include "VaroniaStats.h"
 
-FString UVaroniaMqttLibrary::FormatMqttMessage(int32 ClientID, FString MethodName, int32 SoftStateValue)
+FString UVaroniaMqttLibrary::FormatMqttMessage(int32 ClientID, FString MethodName, int32 SoftStateValue, const FString& PlayerName)
 {
+    VARONIA_SCOPE_STAT(FormatMessage);
+
     TSharedPtr<FJsonObject> RootObject = MakeShareable(new FJsonObject());
 
     RootObject->SetNumberField(TEXT("CallerDeviceID"), ClientID);
@@ -11,10 +15,11 @@ FString UVaroniaMqttLibrary::FormatMqttMessage(int32 ClientID, FString MethodNam
     RootObject->SetStringField(TEXT("sMethod"), MethodName);
 
     // On n'ajoute "Items" que si SoftStateValue a t fourni (!= -1)
-    if (SoftStateValue != -1)
+    if (SoftStateValue != -1 || !PlayerName.IsEmpty())
     {
         TSharedPtr<FJsonObject> ItemsObject = MakeShareable(new FJsonObject());
-        ItemsObject->SetNumberField(TEXT("SoftState"), SoftStateValue);
+        if (SoftStateValue != -1) ItemsObject->SetNumberField(TEXT("SoftState"), SoftStateValue);
+        if (!PlayerName.IsEmpty()) ItemsObject->SetStringField(TEXT("PlayerName"), PlayerName);
         RootObject->SetObjectField(TEXT("Items"), ItemsObject);
     }
 
@@ -23,4 +28,15 @@ FString UVaroniaMqttLibrary::FormatMqttMessage(int32 ClientID, FString MethodNam
     FJsonSerializer::Serialize(RootObject.ToSharedRef(), Writer);
 
     return OutputString;
+}
+
+bool UVaroniaMqttLibrary::ParseMqttMessage(const FString& Message, FVaroniaMqttPayload& OutPayload)
+{
+    VARONIA_SCOPE_STAT(ParseMessage);
+
+    // Fields missing from the JSON keep these defaults
+    OutPayload = FVaroniaMqttPayload();
+    OutPayload.Items.SoftState = -1;
+
+    return FJsonObjectConverter::JsonObjectStringToUStruct(Message, &OutPayload, 0, 0);
 }
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "VaroniaMqttRecorder.h"
+#include "VaroniaBackOfficeManager.h"
+#include "HAL/FileManager.h"
+
+// ============================================================================
+// Recorder
+// ============================================================================
+
+FVaroniaMqttRecorder::~FVaroniaMqttRecorder()
+{
+    Close();
+}
+
+bool FVaroniaMqttRecorder::Open(const FString& Path)
+{
+    Close();
+
+    File = MakeShareable(IFileManager::Get().CreateFileWriter(*Path));
+    if (!File.IsValid())
+    {
+        UE_LOG(LogVaronia, Error, TEXT("Cannot open MQTT recording %s"), *Path);
+        return false;
+    }
+
+    uint32 HeaderMagic = Magic;
+    uint16 HeaderVersion = Version;
+    uint16 Reserved = 0;
+    int64 StartTicks = FDateTime::UtcNow().GetTicks();
+    *File << HeaderMagic << HeaderVersion << Reserved << StartTicks;
+
+    TopicIndices.Reset();
+    LastRecordTime = FPlatformTime::Seconds();
+    return true;
+}
+
+void FVaroniaMqttRecorder::Close()
+{
+    if (!File.IsValid()) return;
+
+    Flush();
+    LastFlush.Wait();
+    File->Close();
+    File.Reset();
+}
+
+void FVaroniaMqttRecorder::Record(EVaroniaMqttDirection Direction, const FString& Topic, const TArray<uint8>& Payload)
+{
+    if (!File.IsValid()) return;
+
+    uint16* Index = TopicIndices.Find(Topic);
+    if (!Index)
+    {
+        const FTCHARToUTF8 Utf8(*Topic);
+        const uint16 NewIndex = (uint16)TopicIndices.Num();
+        const uint16 Length = (uint16)Utf8.Length();
+        Index = &TopicIndices.Add(Topic, NewIndex);
+
+        Pending.Add(0);
+        Pending.Append(reinterpret_cast<const uint8*>(&NewIndex), sizeof(NewIndex));
+        Pending.Append(reinterpret_cast<const uint8*>(&Length), sizeof(Length));
+        Pending.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Length);
+    }
+
+    const double Now = FPlatformTime::Seconds();
+    const uint32 DeltaMicros = (uint32)FMath::Clamp((Now - LastRecordTime) * 1e6, 0.0, (double)MAX_uint32);
+    const uint32 Length = (uint32)Payload.Num();
+    LastRecordTime = Now;
+
+    Pending.Add((uint8)Direction);
+    Pending.Append(reinterpret_cast<const uint8*>(&DeltaMicros), sizeof(DeltaMicros));
+    Pending.Append(reinterpret_cast<const uint8*>(Index), sizeof(uint16));
+    Pending.Append(reinterpret_cast<const uint8*>(&Length), sizeof(Length));
+    Pending.Append(Payload);
+
+    if (Pending.Num() >= FlushThreshold)
+    {
+        Flush();
+    }
+}
+
+void FVaroniaMqttRecorder::Flush()
+{
+    if (Pending.Num() == 0) return;
+
+    // Chained on the previous flush so blocks land in order
+    LastFlush = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Archive = File, Block = MoveTemp(Pending)]() mutable
+    {
+        Archive->Serialize(Block.GetData(), Block.Num());
+    }, LastFlush);
+
+    Pending.Reset(FlushThreshold);
+}
+
+// ============================================================================
+// Replayer
+// ============================================================================
+
+bool FVaroniaMqttReplayer::Open(const FString& Path, float InSpeed)
+{
+    File.Reset(IFileManager::Get().CreateFileReader(*Path));
+    if (!File.IsValid()) return false;
+
+    uint32 HeaderMagic = 0;
+    uint16 HeaderVersion = 0;
+    uint16 Reserved = 0;
+    int64 StartTicks = 0;
+    *File << HeaderMagic << HeaderVersion << Reserved << StartTicks;
+
+    if (HeaderMagic != FVaroniaMqttRecorder::Magic || HeaderVersion != FVaroniaMqttRecorder::Version)
+    {
+        UE_LOG(LogVaronia, Error, TEXT("%s is not a Varonia MQTT recording"), *Path);
+        File.Reset();
+        return false;
+    }
+
+    Speed = InSpeed;
+    Topics.Reset();
+    NextRecordTime = 0.0;
+    StartTime = FPlatformTime::Seconds();
+    bHasNext = ReadNext();
+    return true;
+}
+
+bool FVaroniaMqttReplayer::ReadNext()
+{
+    while (File->Tell() < File->TotalSize())
+    {
+        uint8 Kind = 0;
+        *File << Kind;
+
+        if (Kind == 0)
+        {
+            uint16 Index = 0;
+            uint16 Length = 0;
+            *File << Index << Length;
+
+            TArray<uint8> Utf8;
+            Utf8.SetNumUninitialized(Length);
+            File->Serialize(Utf8.GetData(), Length);
+
+            const FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Utf8.GetData()), Length);
+            Topics.SetNum(FMath::Max(Topics.Num(), Index + 1));
+            Topics[Index] = FString(Text.Length(), Text.Get());
+            continue;
+        }
+
+        uint32 DeltaMicros = 0;
+        uint32 Length = 0;
+        *File << DeltaMicros << NextTopic << Length;
+
+        NextPayload.SetNumUninitialized(Length);
+        File->Serialize(NextPayload.GetData(), Length);
+
+        NextDirection = (EVaroniaMqttDirection)Kind;
+        NextRecordTime += DeltaMicros * 1e-6;
+        return !File->IsError() && Topics.IsValidIndex(NextTopic);
+    }
+    return false;
+}
+
+bool FVaroniaMqttReplayer::Tick(double Now, TFunctionRef<void(EVaroniaMqttDirection, const FString&, const TArray<uint8>&)> Deliver)
+{
+    if (!File.IsValid()) return false;
+
+    // Unthrottled replay still yields every few thousand messages so the frame can finish
+    const double PlayTime = (Now - StartTime) * Speed;
+    int32 Budget = 4096;
+
+    while (bHasNext && (Speed <= 0.f || NextRecordTime <= PlayTime) && Budget-- > 0)
+    {
+        Deliver(NextDirection, Topics[NextTopic], NextPayload);
+        bHasNext = ReadNext();
+    }
+
+    if (!bHasNext)
+    {
+        File.Reset();
+    }
+    return bHasNext;
+}
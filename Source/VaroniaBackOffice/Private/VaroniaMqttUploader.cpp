@@ -0,0 +1,251 @@
+#include "VaroniaMqttUploader.h"
+#include "VaroniaMqttClient.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVaroniaUpload, Log, All);
+
+// ============================================================================
+// Queue
+// ============================================================================
+
+FVaroniaMqttUploader::FVaroniaMqttUploader(UVaroniaMqttClient* InClient, int32 InChunkSize, int32 InWindow)
+    : Client(InClient)
+    , ChunkSize(FMath::Max(InChunkSize, 1024))
+    , Window(FMath::Max(InWindow, 1))
+{
+    check(InClient);
+
+    // Kept by the client and replayed on every reconnect
+    InClient->Subscribe(FString::Printf(TEXT("%s/Ack/#"), VaroniaMqttTopics::Upload), 1);
+    MessageHandle = InClient->OnMessageNative.AddRaw(this, &FVaroniaMqttUploader::HandleMessage);
+    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FVaroniaMqttUploader::Tick));
+}
+
+FVaroniaMqttUploader::~FVaroniaMqttUploader()
+{
+    FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    if (UVaroniaMqttClient* MqttClient = Client.Get())
+    {
+        MqttClient->OnMessageNative.Remove(MessageHandle);
+    }
+}
+
+bool FVaroniaMqttUploader::Enqueue(const FString& Path, const FString& RemoteName)
+{
+    IFileManager& FileManager = IFileManager::Get();
+
+    if (FileManager.DirectoryExists(*Path))
+    {
+        TArray<FString> Files;
+        FileManager.FindFilesRecursive(Files, *Path, TEXT("*"), true, false);
+        Files.Sort();
+
+        bool bAll = true;
+        for (const FString& File : Files)
+        {
+            FString Relative = File;
+            FPaths::MakePathRelativeTo(Relative, *(Path / TEXT("")));
+            bAll &= Enqueue(File, RemoteName / Relative);
+        }
+        return bAll;
+    }
+
+    const int64 Size = FileManager.FileSize(*Path);
+    if (Size < 0)
+    {
+        UE_LOG(LogVaroniaUpload, Error, TEXT("Cannot upload %s: file not found"), *Path);
+        return false;
+    }
+
+    TUniquePtr<FTransfer> Transfer = MakeUnique<FTransfer>();
+    Transfer->Path = Path;
+    Transfer->Name = RemoteName;
+    Transfer->Size = Size;
+    Transfer->ChunkCount = FMath::Max(1, (int32)FMath::DivideAndRoundUp(Size, (int64)ChunkSize));
+
+    // Same file, same ID: that is what lets the back office resume after a restart
+    const FString Identity = FString::Printf(TEXT("%s|%lld|%lld|%d"), *RemoteName, Size, FileManager.GetTimeStamp(*Path).GetTicks(), ChunkSize);
+    Transfer->ID = FString::Printf(TEXT("%08x%08x"), FCrc::StrCrc32(*Identity), FCrc::StrCrc32(*RemoteName));
+
+    Queue.Add(MoveTemp(Transfer));
+    return true;
+}
+
+void FVaroniaMqttUploader::Complete(bool bSuccess, const FString& Error)
+{
+    const FString Name = Queue[0]->Name;
+    if (bSuccess)
+    {
+        UE_LOG(LogVaroniaUpload, Log, TEXT("Uploaded %s (%lld bytes)"), *Name, Queue[0]->Size);
+    }
+    else
+    {
+        ++NumFailed;
+        UE_LOG(LogVaroniaUpload, Error, TEXT("Upload of %s failed: %s"), *Name, *Error);
+    }
+
+    Queue.RemoveAt(0);
+    OnFileDone.Broadcast(Name, bSuccess);
+}
+
+// ============================================================================
+// Sending
+// ============================================================================
+
+void FVaroniaMqttUploader::SendBegin(FTransfer& Transfer)
+{
+    TSharedRef<FJsonObject> Begin = MakeShared<FJsonObject>();
+    Begin->SetStringField(TEXT("Name"), Transfer.Name);
+    Begin->SetNumberField(TEXT("Size"), (double)Transfer.Size);
+    Begin->SetNumberField(TEXT("ChunkSize"), ChunkSize);
+    Begin->SetNumberField(TEXT("ChunkCount"), Transfer.ChunkCount);
+    Begin->SetNumberField(TEXT("Sender"), Client->ClientID);
+
+    FString Json;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+    FJsonSerializer::Serialize(Begin, Writer);
+
+    Client->Publish(FString::Printf(TEXT("%s/Begin/%s"), VaroniaMqttTopics::Upload, *Transfer.ID), Json, 1);
+    Transfer.bAwaitingResume = true;
+    Transfer.LastProgress = FPlatformTime::Seconds();
+}
+
+bool FVaroniaMqttUploader::SendChunk(FTransfer& Transfer, int32 Index)
+{
+    if (!Transfer.Reader.IsValid())
+    {
+        Transfer.Reader.Reset(IFileManager::Get().CreateFileReader(*Transfer.Path));
+        if (!Transfer.Reader.IsValid()) return false;
+    }
+
+    const int64 Offset = (int64)Index * ChunkSize;
+    uint32 Size = (uint32)FMath::Min<int64>(ChunkSize, Transfer.Size - Offset);
+
+    // Header then payload straight from the file into one reused buffer
+    constexpr int32 HeaderSize = 5 * sizeof(uint32);
+    Chunk.SetNumUninitialized(HeaderSize + Size);
+    Transfer.Reader->Seek(Offset);
+    Transfer.Reader->Serialize(Chunk.GetData() + HeaderSize, Size);
+    if (Transfer.Reader->IsError()) return false;
+
+    uint32 Magic = ChunkMagic;
+    uint32 ChunkIndex = (uint32)Index;
+    uint32 Count = (uint32)Transfer.ChunkCount;
+    uint32 Crc = FCrc::MemCrc32(Chunk.GetData() + HeaderSize, Size);
+    TArray<uint8> Header;
+    FMemoryWriter Ar(Header);
+    Ar << Magic << ChunkIndex << Count << Size << Crc;
+    FMemory::Memcpy(Chunk.GetData(), Header.GetData(), HeaderSize);
+
+    Client->PublishBytes(FString::Printf(TEXT("%s/Data/%s"), VaroniaMqttTopics::Upload, *Transfer.ID), Chunk, 1);
+    return true;
+}
+
+bool FVaroniaMqttUploader::Tick(float DeltaTime)
+{
+    UVaroniaMqttClient* MqttClient = Client.Get();
+    if (!MqttClient || Queue.IsEmpty()) return true;
+
+    FTransfer& Transfer = *Queue[0];
+
+    // Whatever was in flight is lost with the connection; Begin again once back
+    if (!MqttClient->IsConnected())
+    {
+        if (bWasConnected) UE_LOG(LogVaroniaUpload, Warning, TEXT("Connection lost during %s, will resume"), *Transfer.Name);
+        bWasConnected = false;
+        Transfer.bBegun = false;
+        return true;
+    }
+    bWasConnected = true;
+
+    if (!Transfer.bBegun)
+    {
+        Transfer.bBegun = true;
+        SendBegin(Transfer);
+        return true;
+    }
+
+    const double Now = FPlatformTime::Seconds();
+    if (Now - Transfer.LastProgress > AckTimeout)
+    {
+        if (++Transfer.Retries > MaxRetries)
+        {
+            Complete(false, TEXT("no acknowledgement from the back office"));
+            return true;
+        }
+
+        // Go back to the last acknowledged chunk (or ask again where to resume)
+        if (Transfer.bAwaitingResume) SendBegin(Transfer);
+        Transfer.NextToSend = Transfer.Acked;
+        Transfer.LastProgress = Now;
+    }
+
+    if (Transfer.bAwaitingResume) return true;
+
+    while (Transfer.NextToSend < Transfer.ChunkCount && Transfer.NextToSend < Transfer.Acked + Window)
+    {
+        if (!SendChunk(Transfer, Transfer.NextToSend))
+        {
+            Complete(false, FString::Printf(TEXT("cannot read %s"), *Transfer.Path));
+            return true;
+        }
+        ++Transfer.NextToSend;
+    }
+    return true;
+}
+
+// ============================================================================
+// Acknowledgements
+// ============================================================================
+
+void FVaroniaMqttUploader::HandleMessage(const FString& Topic, const TArray<uint8>& Payload)
+{
+    if (Queue.IsEmpty()) return;
+
+    FTransfer& Transfer = *Queue[0];
+    if (!Topic.EndsWith(Transfer.ID) || !Topic.StartsWith(FString::Printf(TEXT("%s/Ack/"), VaroniaMqttTopics::Upload))) return;
+
+    const FString Json(FUTF8ToTCHAR((const ANSICHAR*)Payload.GetData(), Payload.Num()));
+    TSharedPtr<FJsonObject> Ack;
+    if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Ack) || !Ack.IsValid()) return;
+
+    FString Error;
+    if (Ack->TryGetStringField(TEXT("Error"), Error) && !Error.IsEmpty())
+    {
+        Complete(false, Error);
+        return;
+    }
+
+    int32 Next = 0;
+    if (!Ack->TryGetNumberField(TEXT("Next"), Next)) return;
+    Next = FMath::Clamp(Next, 0, Transfer.ChunkCount);
+
+    if (Transfer.bAwaitingResume)
+    {
+        if (Next > 0) UE_LOG(LogVaroniaUpload, Log, TEXT("Resuming %s at chunk %d/%d"), *Transfer.Name, Next, Transfer.ChunkCount);
+        Transfer.bAwaitingResume = false;
+        Transfer.Acked = Next;
+        Transfer.NextToSend = Next;
+    }
+    else if (Next > Transfer.Acked)
+    {
+        Transfer.Acked = Next;
+        Transfer.NextToSend = FMath::Max(Transfer.NextToSend, Next);
+    }
+    else
+    {
+        return;
+    }
+
+    Transfer.LastProgress = FPlatformTime::Seconds();
+    Transfer.Retries = 0;
+    if (Transfer.Acked == Transfer.ChunkCount)
+    {
+        Complete(true);
+    }
+}
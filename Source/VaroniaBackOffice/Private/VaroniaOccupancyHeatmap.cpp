@@ -0,0 +1,193 @@
+#include "VaroniaOccupancyHeatmap.h"
+#include "VaroniaSpatialMath.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/BufferArchive.h"
+
+bool FVaroniaOccupancyHeatmap::Init(const FSpatialConfig& Config, float InCellSize, float InContactDistance)
+{
+    const FSpatialBoundary* Main = Config.Boundaries.FindByPredicate([](const FSpatialBoundary& B) { return B.bMainBoundary; });
+    if (!Main || Main->Points.Num() < 3)
+    {
+        Width = Height = 0;
+        return false;
+    }
+
+    const FBox2D Bounds = VaroniaSpatial::GetBounds2D(Main->Points);
+    const FVector2D Size = Bounds.GetSize();
+
+    const float NewCellSize = FMath::Max(FMath::Max(InCellSize, 1.f), (float)FMath::Sqrt(Size.X * Size.Y / MaxCells));
+    const int32 NewWidth = FMath::Clamp(FMath::CeilToInt(Size.X / NewCellSize), 1, MaxCells);
+    const int32 NewHeight = FMath::Clamp(FMath::CeilToInt(Size.Y / NewCellSize), 1, MaxCells / NewWidth);
+
+    // Same grid (e.g. a patch that only moved sub-zones): keep what was accumulated
+    const bool bKeepCells = IsValid() && NewCellSize == CellSize && NewWidth == Width && NewHeight == Height && Bounds.Min == Origin;
+
+    CellSize = NewCellSize;
+    ContactDistance = InContactDistance;
+    Origin = Bounds.Min;
+    Width = NewWidth;
+    Height = NewHeight;
+
+    if (!bKeepCells)
+    {
+        Cells.Reset(new std::atomic<uint32>[Width * Height]);
+        for (int32 i = 0; i < Width * Height; ++i)
+        {
+            Cells[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    TArray<FContactZone> NewZones;
+    for (const FSpatialBoundary& Boundary : Config.Boundaries)
+    {
+        if (Boundary.Points.Num() < 2) continue;
+
+        FContactZone& Zone = NewZones.AddDefaulted_GetRef();
+        Zone.ID = Boundary.ID;
+        Zone.Points = Boundary.Points;
+        Zone.Bounds = VaroniaSpatial::GetBounds2D(Boundary.Points).ExpandBy(ContactDistance);
+    }
+
+    // Contacts follow the boundary ID, so a patch that reshapes or adds sub-zones keeps the others' counts
+    TUniquePtr<std::atomic<uint32>[]> NewContacts(new std::atomic<uint32>[FMath::Max(NewZones.Num(), 1)]);
+    for (int32 i = 0; i < NewZones.Num(); ++i)
+    {
+        const int32 Previous = Zones.IndexOfByPredicate([&NewZones, i](const FContactZone& Zone) { return Zone.ID == NewZones[i].ID; });
+        NewContacts[i].store(Previous != INDEX_NONE ? Contacts[Previous].load(std::memory_order_relaxed) : 0, std::memory_order_relaxed);
+    }
+
+    Zones = MoveTemp(NewZones);
+    Contacts = MoveTemp(NewContacts);
+    return true;
+}
+
+void FVaroniaOccupancyHeatmap::Reset()
+{
+    for (int32 i = 0; i < Width * Height; ++i)
+    {
+        Cells[i].store(0, std::memory_order_relaxed);
+    }
+    for (int32 i = 0; i < Zones.Num(); ++i)
+    {
+        Contacts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void FVaroniaOccupancyHeatmap::AddSample(const FVector& Location)
+{
+    if (!IsValid()) return;
+
+    const FVector2D P(Location.X, Location.Y);
+    const int32 X = FMath::FloorToInt((P.X - Origin.X) / CellSize);
+    const int32 Y = FMath::FloorToInt((P.Y - Origin.Y) / CellSize);
+    if (X >= 0 && X < Width && Y >= 0 && Y < Height)
+    {
+        Cells[Y * Width + X].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const double ContactSq = FMath::Square((double)ContactDistance);
+    for (int32 i = 0; i < Zones.Num(); ++i)
+    {
+        const FContactZone& Zone = Zones[i];
+        if (Zone.Bounds.IsInside(P) && VaroniaSpatial::DistSquaredToPolygonEdge(Zone.Points, P) <= ContactSq)
+        {
+            Contacts[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void FVaroniaOccupancyHeatmap::Scale(std::atomic<uint32>& Counter, float Factor)
+{
+    uint32 Value = Counter.load(std::memory_order_relaxed);
+    while (Value && !Counter.compare_exchange_weak(Value, (uint32)(Value * Factor), std::memory_order_relaxed))
+    {
+    }
+}
+
+void FVaroniaOccupancyHeatmap::Decay(float Factor)
+{
+    for (int32 i = 0; i < Width * Height; ++i)
+    {
+        Scale(Cells[i], Factor);
+    }
+    for (int32 i = 0; i < Zones.Num(); ++i)
+    {
+        Scale(Contacts[i], Factor);
+    }
+}
+
+TMap<FString, uint32> FVaroniaOccupancyHeatmap::GetContacts() const
+{
+    TMap<FString, uint32> Result;
+    for (int32 i = 0; i < Zones.Num(); ++i)
+    {
+        Result.Add(Zones[i].ID, Contacts[i].load(std::memory_order_relaxed));
+    }
+    return Result;
+}
+
+bool FVaroniaOccupancyHeatmap::ExportPNG(const FString& Path) const
+{
+    if (!IsValid()) return false;
+
+    uint32 Max = 1;
+    for (int32 i = 0; i < Width * Height; ++i)
+    {
+        Max = FMath::Max(Max, Cells[i].load(std::memory_order_relaxed));
+    }
+
+    // Oriented like the ortho captures so the two can be overlaid: world -X to the right, +Y up
+    TArray<uint8> Pixels;
+    Pixels.SetNumUninitialized(Width * Height);
+    const float InvSqrtMax = 1.f / FMath::Sqrt((float)Max);
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        for (int32 X = 0; X < Width; ++X)
+        {
+            const uint32 Count = Cells[Y * Width + X].load(std::memory_order_relaxed);
+            Pixels[(Height - 1 - Y) * Width + (Width - 1 - X)] = (uint8)FMath::RoundToInt(255.f * FMath::Sqrt((float)Count) * InvSqrtMax);
+        }
+    }
+
+    IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+    TSharedPtr<IImageWrapper> Png = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+    if (!Png.IsValid() || !Png->SetRaw(Pixels.GetData(), Pixels.Num(), Width, Height, ERGBFormat::Gray, 8)) return false;
+
+    return FFileHelper::SaveArrayToFile(Png->GetCompressed(), *Path);
+}
+
+bool FVaroniaOccupancyHeatmap::ExportBinary(const FString& Path) const
+{
+    if (!IsValid()) return false;
+
+    FBufferArchive Ar;
+    uint32 Magic = FileMagic;
+    uint16 Version = 1;
+    uint16 Reserved = 0;
+    int32 W = Width;
+    int32 H = Height;
+    float Cell = CellSize;
+    float OriginX = (float)Origin.X;
+    float OriginY = (float)Origin.Y;
+    Ar << Magic << Version << Reserved << W << H << Cell << OriginX << OriginY;
+
+    for (int32 i = 0; i < Width * Height; ++i)
+    {
+        uint32 Count = Cells[i].load(std::memory_order_relaxed);
+        Ar << Count;
+    }
+
+    int32 ZoneCount = Zones.Num();
+    Ar << ZoneCount;
+    for (int32 i = 0; i < Zones.Num(); ++i)
+    {
+        FString ID = Zones[i].ID;
+        uint32 Count = Contacts[i].load(std::memory_order_relaxed);
+        Ar << ID << Count;
+    }
+
+    return FFileHelper::SaveArrayToFile(Ar, *Path);
+}
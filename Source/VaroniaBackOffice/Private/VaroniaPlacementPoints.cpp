@@ -0,0 +1,273 @@
+#include "VaroniaPlacementPoints.h"
+#include "VaroniaSpatialMath.h"
+#include "Async/ParallelFor.h"
+
+static const FSpatialBoundary* FindMainBoundary(const FSpatialConfig& Config)
+{
+    return Config.Boundaries.FindByPredicate([](const FSpatialBoundary& B) { return B.bMainBoundary && B.Points.Num() >= 3; });
+}
+
+// ============================================================================
+// Build / Update
+// ============================================================================
+
+bool FVaroniaPlacementPoints::Build(const FSpatialConfig& Config, float InSpacing, float InClearance)
+{
+    Points.Reset();
+    Grid.Reset();
+    Valid.Reset();
+    FieldW = FieldH = GridW = GridH = 0;
+
+    const FSpatialBoundary* Main = FindMainBoundary(Config);
+    if (!Main) return false;
+
+    Spacing = FMath::Max(InSpacing, 10.f);
+    Clearance = FMath::Max(InClearance, 0.f);
+    MainPoints = Main->Points;
+    Bounds = VaroniaSpatial::GetBounds2D(Main->Points);
+    FloorZ = Main->Points[0].Z;
+    for (const FVector& Point : Main->Points)
+    {
+        FloorZ = FMath::Min(FloorZ, (float)Point.Z);
+    }
+
+    // Fine enough to resolve the clearance band, capped at ~1M cells
+    const FVector2D Size = Bounds.GetSize();
+    FieldCell = FMath::Max3(FMath::Min(Spacing, FMath::Max(Clearance, 10.f)) * 0.25f, 2.f, (float)FMath::Sqrt(Size.X * Size.Y / (1024.0 * 1024.0)));
+    FieldW = FMath::Max(FMath::CeilToInt(Size.X / FieldCell), 1);
+    FieldH = FMath::Max(FMath::CeilToInt(Size.Y / FieldCell), 1);
+    Valid.SetNumZeroed(FieldW * FieldH);
+
+    GridCell = Spacing / UE_SQRT_2;
+    GridW = FMath::Max(FMath::CeilToInt(Size.X / GridCell), 1);
+    GridH = FMath::Max(FMath::CeilToInt(Size.Y / GridCell), 1);
+    Grid.Init(INDEX_NONE, GridW * GridH);
+
+    ComputeValidity(Config, Bounds);
+    Sample(Bounds, GetTypeHash(Config.ID));
+    return true;
+}
+
+void FVaroniaPlacementPoints::Update(const FSpatialConfig& Config, const FBox2D& Dirty)
+{
+    const FSpatialBoundary* Main = FindMainBoundary(Config);
+    if (!Main || Main->Points != MainPoints || FieldW == 0)
+    {
+        Build(Config, Spacing, Clearance);
+        return;
+    }
+    if (!Dirty.bIsValid) return;
+
+    // Validity near a moved edge changes up to Clearance (plus a cell) away. Sampling is cheap next to
+    // the validity field but order-dependent, so it is redone in full to land on Build()'s points
+    ComputeValidity(Config, Dirty.ExpandBy(Clearance + 2.f * FieldCell));
+
+    Points.Reset();
+    Grid.Init(INDEX_NONE, GridW * GridH);
+    Sample(Bounds, GetTypeHash(Config.ID));
+}
+
+FBox2D FVaroniaPlacementPoints::GetChangedArea(const FSpatialConfig& Old, const FSpatialConfig& New)
+{
+    FBox2D Area(ForceInit);
+    auto AddDifferences = [&Area](const FSpatialConfig& A, const FSpatialConfig& B)
+    {
+        for (const FSpatialBoundary& Boundary : A.Boundaries)
+        {
+            const FSpatialBoundary* Other = B.Boundaries.FindByPredicate([&Boundary](const FSpatialBoundary& O) { return O.ID == Boundary.ID; });
+            if (!Other || Other->Points != Boundary.Points || Other->bReverse != Boundary.bReverse)
+            {
+                Area += VaroniaSpatial::GetBounds2D(Boundary.Points);
+            }
+        }
+    };
+    AddDifferences(Old, New);
+    AddDifferences(New, Old);
+    return Area;
+}
+
+// ============================================================================
+// Validity field
+// ============================================================================
+
+void FVaroniaPlacementPoints::ComputeValidity(const FSpatialConfig& Config, const FBox2D& Region)
+{
+    const int32 X0 = FMath::Clamp(FMath::FloorToInt((Region.Min.X - Bounds.Min.X) / FieldCell), 0, FieldW - 1);
+    const int32 X1 = FMath::Clamp(FMath::CeilToInt((Region.Max.X - Bounds.Min.X) / FieldCell), 0, FieldW - 1);
+    const int32 Y0 = FMath::Clamp(FMath::FloorToInt((Region.Min.Y - Bounds.Min.Y) / FieldCell), 0, FieldH - 1);
+    const int32 Y1 = FMath::Clamp(FMath::CeilToInt((Region.Max.Y - Bounds.Min.Y) / FieldCell), 0, FieldH - 1);
+
+    // Tested at the cell centre but candidates land anywhere in the cell: half a diagonal more keeps
+    // every point of a valid cell inside and at least Clearance from the edges
+    const double ClearanceSq = FMath::Square(Clearance + FieldCell * 0.5 * UE_SQRT_2);
+
+    ParallelFor(Y1 - Y0 + 1, [&](int32 Row)
+    {
+        const int32 Y = Y0 + Row;
+        for (int32 X = X0; X <= X1; ++X)
+        {
+            const FVector2D P = Bounds.Min + FVector2D(X + 0.5, Y + 0.5) * FieldCell;
+
+            bool bValid = VaroniaSpatial::IsInsidePolygon(MainPoints, P);
+            for (int32 i = 0; bValid && i < Config.Boundaries.Num(); ++i)
+            {
+                const FSpatialBoundary& Boundary = Config.Boundaries[i];
+                if (Boundary.Points.Num() < 2) continue;
+
+                bValid = VaroniaSpatial::DistSquaredToPolygonEdge(Boundary.Points, P) >= ClearanceSq
+                    && !(Boundary.bReverse && !Boundary.bMainBoundary && VaroniaSpatial::IsInsidePolygon(Boundary.Points, P));
+            }
+            Valid[Y * FieldW + X] = bValid ? 1 : 0;
+        }
+    });
+}
+
+bool FVaroniaPlacementPoints::IsValidAt(const FVector2D& P) const
+{
+    const int32 X = FMath::FloorToInt((P.X - Bounds.Min.X) / FieldCell);
+    const int32 Y = FMath::FloorToInt((P.Y - Bounds.Min.Y) / FieldCell);
+    return X >= 0 && X < FieldW && Y >= 0 && Y < FieldH && Valid[Y * FieldW + X];
+}
+
+// ============================================================================
+// Poisson-disk sampling
+// ============================================================================
+
+bool FVaroniaPlacementPoints::HasNeighbour(const FVector2D& P) const
+{
+    const int32 CX = FMath::FloorToInt((P.X - Bounds.Min.X) / GridCell);
+    const int32 CY = FMath::FloorToInt((P.Y - Bounds.Min.Y) / GridCell);
+    const double SpacingSq = FMath::Square((double)Spacing);
+
+    for (int32 Y = FMath::Max(CY - 2, 0); Y <= FMath::Min(CY + 2, GridH - 1); ++Y)
+    {
+        for (int32 X = FMath::Max(CX - 2, 0); X <= FMath::Min(CX + 2, GridW - 1); ++X)
+        {
+            const int32 Index = Grid[Y * GridW + X];
+            if (Index != INDEX_NONE && FVector2D::DistSquared(P, FVector2D(Points[Index].X, Points[Index].Y)) < SpacingSq)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void FVaroniaPlacementPoints::AddPoint(const FVector2D& P)
+{
+    const int32 CX = FMath::Clamp(FMath::FloorToInt((P.X - Bounds.Min.X) / GridCell), 0, GridW - 1);
+    const int32 CY = FMath::Clamp(FMath::FloorToInt((P.Y - Bounds.Min.Y) / GridCell), 0, GridH - 1);
+    Grid[CY * GridW + CX] = Points.Add(FVector(P.X, P.Y, FloorZ));
+}
+
+void FVaroniaPlacementPoints::Sample(const FBox2D& Region, uint32 Seed)
+{
+    FRandomStream Random(Seed);
+    TArray<FVector2D> Active;
+
+    auto Grow = [&]()
+    {
+        // Bridson: try candidates in the [r, 2r] annulus around a random active point
+        while (Active.Num() > 0)
+        {
+            const int32 ActiveIndex = Random.RandHelper(Active.Num());
+            const FVector2D Center = Active[ActiveIndex];
+            bool bPlaced = false;
+
+            for (int32 Attempt = 0; Attempt < 30 && !bPlaced; ++Attempt)
+            {
+                const float Angle = Random.FRand() * UE_TWO_PI;
+                const float Radius = Spacing * (1.f + Random.FRand());
+                const FVector2D Candidate = Center + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Radius;
+
+                if (Region.IsInside(Candidate) && IsValidAt(Candidate) && !HasNeighbour(Candidate))
+                {
+                    AddPoint(Candidate);
+                    Active.Add(Candidate);
+                    bPlaced = true;
+                }
+            }
+
+            if (!bPlaced)
+            {
+                Active.RemoveAtSwap(ActiveIndex);
+            }
+        }
+    };
+
+    // Every valid cell left uncovered seeds a new front, so separate islands all get filled
+    const int32 X0 = FMath::Clamp(FMath::FloorToInt((Region.Min.X - Bounds.Min.X) / FieldCell), 0, FieldW - 1);
+    const int32 X1 = FMath::Clamp(FMath::CeilToInt((Region.Max.X - Bounds.Min.X) / FieldCell), 0, FieldW - 1);
+    const int32 Y0 = FMath::Clamp(FMath::FloorToInt((Region.Min.Y - Bounds.Min.Y) / FieldCell), 0, FieldH - 1);
+    const int32 Y1 = FMath::Clamp(FMath::CeilToInt((Region.Max.Y - Bounds.Min.Y) / FieldCell), 0, FieldH - 1);
+
+    for (int32 Y = Y0; Y <= Y1; ++Y)
+    {
+        for (int32 X = X0; X <= X1; ++X)
+        {
+            if (!Valid[Y * FieldW + X]) continue;
+
+            const FVector2D Start = Bounds.Min + FVector2D(X + 0.5, Y + 0.5) * FieldCell;
+            if (!Region.IsInside(Start) || HasNeighbour(Start)) continue;
+
+            AddPoint(Start);
+            Active.Add(Start);
+            Grow();
+        }
+    }
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+bool FVaroniaPlacementPoints::GetRandom(FVector& OutPoint) const
+{
+    if (Points.Num() == 0) return false;
+
+    OutPoint = Points[FMath::RandHelper(Points.Num())];
+    return true;
+}
+
+bool FVaroniaPlacementPoints::GetNearest(const FVector& Location, FVector& OutPoint) const
+{
+    if (Points.Num() == 0) return false;
+
+    const FVector2D P(Location.X, Location.Y);
+    const int32 CX = FMath::Clamp(FMath::FloorToInt((P.X - Bounds.Min.X) / GridCell), 0, GridW - 1);
+    const int32 CY = FMath::Clamp(FMath::FloorToInt((P.Y - Bounds.Min.Y) / GridCell), 0, GridH - 1);
+
+    // Grow square rings until the ring is farther than the best hit so far
+    double BestSq = TNumericLimits<double>::Max();
+    int32 Best = INDEX_NONE;
+    const int32 MaxRing = FMath::Max(GridW, GridH);
+
+    for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+    {
+        if (Best != INDEX_NONE && FMath::Square((Ring - 1) * (double)GridCell) > BestSq) break;
+
+        for (int32 Y = CY - Ring; Y <= CY + Ring; ++Y)
+        {
+            if (Y < 0 || Y >= GridH) continue;
+
+            const bool bEdgeRow = FMath::Abs(Y - CY) == Ring;
+            for (int32 X = CX - Ring; X <= CX + Ring; X += bEdgeRow ? 1 : FMath::Max(2 * Ring, 1))
+            {
+                if (X < 0 || X >= GridW) continue;
+
+                const int32 Index = Grid[Y * GridW + X];
+                if (Index == INDEX_NONE) continue;
+
+                const double DistSq = FVector2D::DistSquared(P, FVector2D(Points[Index].X, Points[Index].Y));
+                if (DistSq < BestSq)
+                {
+                    BestSq = DistSq;
+                    Best = Index;
+                }
+            }
+        }
+    }
+
+    OutPoint = Points[Best];
+    return true;
+}
@@ -0,0 +1,207 @@
+#include "VaroniaPoseJitterBuffer.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// ============================================================================
+// Wire format
+// ============================================================================
+
+void FVaroniaPoseMessage::Encode(TArray<uint8>& OutBytes) const
+{
+    OutBytes.Reset(40);
+    FMemoryWriter Writer(OutBytes);
+
+    int32 ID = DeviceID;
+    double Time = Timestamp;
+    float Values[7] = {
+        (float)Location.X, (float)Location.Y, (float)Location.Z,
+        (float)Rotation.X, (float)Rotation.Y, (float)Rotation.Z, (float)Rotation.W
+    };
+
+    Writer << ID << Time;
+    for (float& V : Values) { Writer << V; }
+}
+
+bool FVaroniaPoseMessage::Decode(const TArray<uint8>& Bytes, FVaroniaPoseMessage& OutMessage)
+{
+    if (Bytes.Num() != 40) return false;
+
+    FMemoryReader Reader(Bytes);
+    float Values[7];
+
+    Reader << OutMessage.DeviceID << OutMessage.Timestamp;
+    for (float& V : Values) { Reader << V; }
+
+    OutMessage.Location = FVector(Values[0], Values[1], Values[2]);
+    OutMessage.Rotation = FQuat(Values[3], Values[4], Values[5], Values[6]).GetNormalized();
+    return !Reader.IsError();
+}
+
+// ============================================================================
+// Ring buffer
+// ============================================================================
+
+void FVaroniaPoseJitterBuffer::Reset()
+{
+    Head = 0;
+    Count = 0;
+    bHasOffset = false;
+    Jitter = 0.0;
+    PlayoutDelay = MinPlayoutDelay;
+    LastPlayoutTime = -DBL_MAX;
+    Stats = FVaroniaJitterStats();
+}
+
+void FVaroniaPoseJitterBuffer::InsertAt(int32 Index, const FSample& Sample)
+{
+    if (Count == Capacity)
+    {
+        // Full: evict the oldest sample to make room
+        DropFront(1);
+        Stats.Dropped++;
+        Index = FMath::Max(Index - 1, 0);
+    }
+
+    for (int32 i = Count; i > Index; --i)
+    {
+        At(i) = At(i - 1);
+    }
+    At(Index) = Sample;
+    Count++;
+}
+
+void FVaroniaPoseJitterBuffer::DropFront(int32 Num)
+{
+    Num = FMath::Min(Num, Count);
+    Head = (Head + Num) % Capacity;
+    Count -= Num;
+}
+
+void FVaroniaPoseJitterBuffer::UpdateTiming(double RemoteTime, double LocalTime)
+{
+    const double Transit = LocalTime - RemoteTime;
+
+    if (!bHasOffset)
+    {
+        ClockOffset = Transit;
+        LastTransit = Transit;
+        PlayoutDelay = MinPlayoutDelay;
+        bHasOffset = true;
+        return;
+    }
+
+    // Track the fastest packets; creep up slowly so clock drift does not leave us stuck
+    ClockOffset = (Transit < ClockOffset) ? Transit : ClockOffset + (Transit - ClockOffset) * 0.002;
+
+    // RFC 3550 interarrival jitter
+    Jitter += (FMath::Abs(Transit - LastTransit) - Jitter) / 16.0;
+    LastTransit = Transit;
+
+    // Grow the delay quickly, shrink it slowly
+    const double Target = FMath::Clamp(MinPlayoutDelay + JitterMultiplier * Jitter, MinPlayoutDelay, MaxPlayoutDelay);
+    const double Rate = (Target > PlayoutDelay) ? 0.25 : 0.01;
+    PlayoutDelay += (Target - PlayoutDelay) * Rate;
+}
+
+void FVaroniaPoseJitterBuffer::Push(double RemoteTime, double LocalTime, const FVector& Location, const FQuat& Rotation)
+{
+    UpdateTiming(RemoteTime, LocalTime);
+
+    Stats.PlayoutDelayMs = (float)(PlayoutDelay * 1000.0);
+    Stats.JitterMs = (float)(Jitter * 1000.0);
+
+    if (RemoteTime <= LastPlayoutTime)
+    {
+        Stats.Late++;
+        return;
+    }
+
+    // Common case appends; reordered packets walk back to their slot
+    int32 Index = Count;
+    while (Index > 0 && At(Index - 1).Time >= RemoteTime)
+    {
+        if (At(Index - 1).Time == RemoteTime)
+        {
+            Stats.Dropped++;
+            return;
+        }
+        --Index;
+    }
+
+    FSample Sample;
+    Sample.Time = RemoteTime;
+    Sample.Location = Location;
+    Sample.Rotation = Rotation;
+    InsertAt(Index, Sample);
+    Stats.Received++;
+}
+
+FVector FVaroniaPoseJitterBuffer::TangentAt(int32 Index) const
+{
+    // Finite-difference (Catmull-Rom style) velocity, one-sided at the ends
+    const int32 Prev = FMath::Max(Index - 1, 0);
+    const int32 Next = FMath::Min(Index + 1, Count - 1);
+    const double Dt = At(Next).Time - At(Prev).Time;
+    if (Prev == Next || Dt <= KINDA_SMALL_NUMBER) return FVector::ZeroVector;
+
+    return (At(Next).Location - At(Prev).Location) / Dt;
+}
+
+bool FVaroniaPoseJitterBuffer::Sample(double LocalTime, FTransform& OutPose)
+{
+    if (Count == 0) return false;
+
+    const double PlayoutTime = FMath::Max(LocalTime - ClockOffset - PlayoutDelay, LastPlayoutTime);
+    LastPlayoutTime = PlayoutTime;
+
+    const FSample& Oldest = At(0);
+    const FSample& Newest = At(Count - 1);
+
+    if (PlayoutTime <= Oldest.Time)
+    {
+        OutPose = FTransform(Oldest.Rotation, Oldest.Location);
+        return true;
+    }
+
+    if (PlayoutTime >= Newest.Time)
+    {
+        const double Ahead = PlayoutTime - Newest.Time;
+        if (Ahead > MaxExtrapolation) { Stats.Starved++; }
+        else { Stats.Extrapolated++; }
+
+        // Linear extrapolation from the last segment, clamped to MaxExtrapolation
+        FVector Location = Newest.Location;
+        FQuat Rotation = Newest.Rotation;
+        if (Count >= 2)
+        {
+            const FSample& Before = At(Count - 2);
+            const double Dt = Newest.Time - Before.Time;
+            if (Dt > KINDA_SMALL_NUMBER)
+            {
+                const double Alpha = FMath::Min(Ahead, MaxExtrapolation) / Dt;
+                Location += (Newest.Location - Before.Location) * Alpha;
+                Rotation = FQuat::Slerp(Before.Rotation, Newest.Rotation, 1.0 + Alpha);
+            }
+        }
+        OutPose = FTransform(Rotation, Location);
+        return true;
+    }
+
+    // Find the segment [i, i+1] containing the playout time
+    int32 i = 0;
+    while (i + 1 < Count && At(i + 1).Time <= PlayoutTime) { ++i; }
+
+    const FSample& A = At(i);
+    const FSample& B = At(i + 1);
+    const double Dt = B.Time - A.Time;
+    const float Alpha = (float)((PlayoutTime - A.Time) / Dt);
+
+    const FVector Location = FMath::CubicInterp(A.Location, TangentAt(i) * Dt, B.Location, TangentAt(i + 1) * Dt, Alpha);
+    const FQuat Rotation = FQuat::Slerp(A.Rotation, B.Rotation, Alpha);
+    OutPose = FTransform(Rotation, Location);
+
+    // Keep one sample before the segment for the tangent, drop the rest
+    if (i > 1) { DropFront(i - 1); }
+
+    return true;
+}
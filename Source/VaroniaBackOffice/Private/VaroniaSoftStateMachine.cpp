@@ -0,0 +1,55 @@
+#include "VaroniaSoftStateMachine.h"
+#include "VaroniaBackOfficeManager.h"
+
+FVaroniaSoftStateMachine::FVaroniaSoftStateMachine(ESoftState InitialState, double Now)
+    : State(InitialState)
+    , EnteredAt(Now)
+{
+    EntryCount[VaroniaSoftState::ToIndex(State)] = 1;
+}
+
+bool FVaroniaSoftStateMachine::TryTransition(ESoftState NewState, double Now)
+{
+    if (NewState == State) return false;
+
+    if (!VaroniaSoftState::CanTransition(State, NewState))
+    {
+        RejectedCount++;
+        const UEnum* StateEnum = StaticEnum<ESoftState>();
+        UE_LOG(LogVaronia, Warning, TEXT("Rejected SoftState transition %s -> %s"),
+            *StateEnum->GetNameStringByValue((int64)State), *StateEnum->GetNameStringByValue((int64)NewState));
+        return false;
+    }
+
+    const ESoftState OldState = State;
+    const int32 OldIndex = VaroniaSoftState::ToIndex(OldState);
+    const int32 NewIndex = VaroniaSoftState::ToIndex(NewState);
+
+    LastSeconds[OldIndex] = Now - EnteredAt;
+    TotalSeconds[OldIndex] += LastSeconds[OldIndex];
+
+    ExitHooks[OldIndex].Broadcast(OldState, NewState);
+
+    State = NewState;
+    EnteredAt = Now;
+    EntryCount[NewIndex]++;
+
+    EnterHooks[NewIndex].Broadcast(OldState, NewState);
+    return true;
+}
+
+TArray<FVaroniaSoftStateMetrics> FVaroniaSoftStateMachine::GetMetrics(double Now) const
+{
+    TArray<FVaroniaSoftStateMetrics> Result;
+    Result.SetNum(VaroniaSoftState::Num);
+
+    for (int32 i = 0; i < VaroniaSoftState::Num; ++i)
+    {
+        FVaroniaSoftStateMetrics& Metrics = Result[i];
+        Metrics.State = VaroniaSoftState::FromIndex(i);
+        Metrics.EntryCount = EntryCount[i];
+        Metrics.LastSeconds = (float)LastSeconds[i];
+        Metrics.TotalSeconds = (float)(TotalSeconds[i] + (Metrics.State == State ? Now - EnteredAt : 0.0));
+    }
+    return Result;
+}
@@ -0,0 +1,19 @@
+#include "VaroniaStats.h"
+
+DEFINE_STAT(STAT_Varonia_ConfigLoad);
+DEFINE_STAT(STAT_Varonia_SpatialParse);
+DEFINE_STAT(STAT_Varonia_MqttSend);
+DEFINE_STAT(STAT_Varonia_MqttReceive);
+DEFINE_STAT(STAT_Varonia_FormatMessage);
+DEFINE_STAT(STAT_Varonia_ParseMessage);
+DEFINE_STAT(STAT_Varonia_ManagerTick);
+DEFINE_STAT(STAT_Varonia_Scheduler);
+
+DEFINE_STAT(STAT_Varonia_MessagesSent);
+DEFINE_STAT(STAT_Varonia_MessagesReceived);
+DEFINE_STAT(STAT_Varonia_SchedulerDeferred);
+
+DEFINE_STAT(STAT_Varonia_SpatialMemory);
+DEFINE_STAT(STAT_Varonia_PoseBufferMemory);
+
+CSV_DEFINE_CATEGORY_MODULE(VARONIABACKOFFICE_API, Varonia, true);
@@ -0,0 +1,117 @@
+#include "VaroniaStructReplicator.h"
+#include "Dom/JsonObject.h"
+#include "JsonObjectConverter.h"
+#include "Serialization/JsonSerializer.h"
+
+// ============================================================================
+// Publisher
+// ============================================================================
+
+FVaroniaStructReplicator::FVaroniaStructReplicator(const UScriptStruct* InStruct, float MaxRateHz)
+    : Struct(InStruct)
+    , Snapshot(InStruct)
+{
+    for (TFieldIterator<FProperty> It(Struct); It; ++It)
+    {
+        Fields.Add(*It);
+    }
+    DirtyMask.Init(true, Fields.Num());
+    MinInterval = MaxRateHz > 0.f ? 1.0 / MaxRateHz : 0.0;
+}
+
+void FVaroniaStructReplicator::Update(const void* Data)
+{
+    uint8* SnapshotData = Snapshot.GetStructMemory();
+
+    for (int32 i = 0; i < Fields.Num(); ++i)
+    {
+        const FProperty* Field = Fields[i];
+        if (!Field->Identical_InContainer(SnapshotData, Data))
+        {
+            Field->CopyCompleteValue_InContainer(SnapshotData, Data);
+            DirtyMask[i] = true;
+        }
+    }
+}
+
+void FVaroniaStructReplicator::MarkAllDirty()
+{
+    DirtyMask.SetRange(0, Fields.Num(), true);
+    bFull = true;
+}
+
+bool FVaroniaStructReplicator::BuildDelta(double Now, FString& OutMessage)
+{
+    if (Now - LastFullTime >= FullRefreshInterval)
+    {
+        MarkAllDirty();
+    }
+
+    if (Now - LastSendTime < MinInterval || DirtyMask.Find(true) == INDEX_NONE) return false;
+
+    const uint8* SnapshotData = Snapshot.GetStructMemory();
+    TSharedRef<FJsonObject> FieldsObject = MakeShared<FJsonObject>();
+
+    for (TConstSetBitIterator<> It(DirtyMask); It; ++It)
+    {
+        const FProperty* Field = Fields[It.GetIndex()];
+        TSharedPtr<FJsonValue> Value = FJsonObjectConverter::UPropertyToJsonValue(const_cast<FProperty*>(Field), Field->ContainerPtrToValuePtr<void>(SnapshotData));
+        if (Value.IsValid())
+        {
+            FieldsObject->SetField(Field->GetName(), Value);
+        }
+    }
+
+    TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+    RootObject->SetNumberField(TEXT("Seq"), ++Sequence);
+    RootObject->SetBoolField(TEXT("Full"), bFull);
+    RootObject->SetObjectField(TEXT("Fields"), FieldsObject);
+
+    OutMessage.Reset();
+    TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutMessage);
+    FJsonSerializer::Serialize(RootObject, Writer);
+
+    if (bFull) { LastFullTime = Now; }
+    LastSendTime = Now;
+    bFull = false;
+    DirtyMask.SetRange(0, Fields.Num(), false);
+    return true;
+}
+
+// ============================================================================
+// Mirror
+// ============================================================================
+
+FVaroniaStructMirror::FVaroniaStructMirror(const UScriptStruct* InStruct)
+    : Struct(InStruct)
+    , Mirror(InStruct)
+{
+}
+
+bool FVaroniaStructMirror::ApplyDelta(const FString& Message)
+{
+    TSharedPtr<FJsonObject> RootObject;
+    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Message);
+    if (!FJsonSerializer::Deserialize(Reader, RootObject) || !RootObject.IsValid()) return false;
+
+    const uint32 Sequence = (uint32)RootObject->GetNumberField(TEXT("Seq"));
+    const bool bFull = RootObject->GetBoolField(TEXT("Full"));
+
+    // Publisher restarts reset its sequence; a full message always resynchronises us
+    if (bHasSequence && Sequence <= LastSequence && !bFull) return false;
+    LastSequence = Sequence;
+    bHasSequence = true;
+
+    const TSharedPtr<FJsonObject>* FieldsObject;
+    if (!RootObject->TryGetObjectField(TEXT("Fields"), FieldsObject)) return false;
+
+    uint8* MirrorData = Mirror.GetStructMemory();
+    for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : (*FieldsObject)->Values)
+    {
+        FProperty* Property = Struct->FindPropertyByName(FName(*Field.Key));
+        if (!Property) continue;
+
+        FJsonObjectConverter::JsonValueToUProperty(Field.Value, Property, Property->ContainerPtrToValuePtr<void>(MirrorData));
+    }
+    return true;
+}
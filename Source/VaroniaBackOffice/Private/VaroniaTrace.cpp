@@ -0,0 +1,42 @@
+#include "VaroniaTrace.h"
+#include "VaroniaBackOfficeManager.h"
+
+UE_TRACE_CHANNEL_DEFINE(VaroniaChannel);
+
+FVaroniaStartupTrace& FVaroniaStartupTrace::Get()
+{
+    static FVaroniaStartupTrace Instance;
+    return Instance;
+}
+
+void FVaroniaStartupTrace::BeginCollecting()
+{
+    FScopeLock ScopeLock(&Lock);
+    Spans.Reset();
+    Origin = FPlatformTime::Seconds();
+    bCollecting = true;
+}
+
+void FVaroniaStartupTrace::AddSpan(const TCHAR* Name, double StartTime, double EndTime)
+{
+    if (!bCollecting) return;
+
+    FScopeLock ScopeLock(&Lock);
+    Spans.Add({ Name, StartTime, EndTime, FPlatformTLS::GetCurrentThreadId() });
+}
+
+void FVaroniaStartupTrace::Finish()
+{
+    if (!bCollecting.exchange(false)) return;
+
+    FScopeLock ScopeLock(&Lock);
+    Spans.Sort([](const FSpan& A, const FSpan& B) { return A.Start < B.Start; });
+
+    UE_LOG(LogVaronia, Log, TEXT("Startup trace (%d spans, %.2f ms total):"), Spans.Num(), (FPlatformTime::Seconds() - Origin) * 1000.0);
+    for (const FSpan& Span : Spans)
+    {
+        UE_LOG(LogVaronia, Log, TEXT("  [+%8.2f ms] %8.2f ms  %-24s (thread %u)"),
+            (Span.Start - Origin) * 1000.0, (Span.End - Span.Start) * 1000.0, Span.Name, Span.ThreadId);
+    }
+    Spans.Empty();
+}
@@ -153,4 +153,53 @@ struct FSpatialConfig {
     /** OrthoKey reference (e.g. "Hostel-BedRooms-Small_6") */
     UPROPERTY(BlueprintReadOnly, Category = "Varonia|Spatial")
     FString OrthoKey;
-};
\ No newline at end of file
+};
+
+// ========================
+// Device Status (replicated to the back office)
+// ========================
+
+/** Live device health mirrored to server devices through UVaroniaMqttClient struct replication */
+USTRUCT(BlueprintType)
+struct FVaroniaDeviceStatus {
+    GENERATED_BODY()
+
+    /** Headset battery level (0-1) */
+    UPROPERTY(BlueprintReadWrite, Category = "Varonia|Status")
+    float Battery = 1.f;
+
+    /** Tracking confidence (0 = lost, 1 = nominal) */
+    UPROPERTY(BlueprintReadWrite, Category = "Varonia|Status")
+    float TrackingQuality = 1.f;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Varonia|Status")
+    float FrameTimeMs = 0.f;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Varonia|Status")
+    FString CurrentLevel;
+};
+
+// ========================
+// Boundary Crossings
+// ========================
+
+/** A device entered or left a sub-zone boundary */
+USTRUCT(BlueprintType)
+struct FVaroniaBoundaryCrossing {
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Spatial")
+    int32 DeviceID = 0;
+
+    /** FSpatialBoundary::ID */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Spatial")
+    FString BoundaryID;
+
+    /** False when leaving */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Spatial")
+    bool bEntered = false;
+
+    /** When the edge was crossed, seconds on the clock of the pose source */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Spatial")
+    double Time = 0.0;
+};
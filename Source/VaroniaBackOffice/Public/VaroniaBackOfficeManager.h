@@ -2,14 +2,35 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "Engine/StreamableManager.h"
+#include "Tasks/Task.h"
 #include "LBE_Types.h"
 #include "VaroniaMqttClient.h"
+#include "VaroniaPoseJitterBuffer.h"
+#include "VaroniaTripleBuffer.h"
+#include "VaroniaClockSync.h"
+#include "VaroniaFleetTable.h"
+#include "VaroniaSoftStateMachine.h"
+#include "VaroniaFrameScheduler.h"
+#include "VaroniaOccupancyHeatmap.h"
+#include "VaroniaPlacementPoints.h"
+#include "VaroniaBoundaryCrossings.h"
 #include "VaroniaBackOfficeManager.generated.h"
 
+class FJsonObject;
+class FJsonValue;
+
 // Custom log category — control in console: Log LogVaronia Verbose / Log LogVaronia Warning
 DECLARE_LOG_CATEGORY_EXTERN(LogVaronia, Log, All);
 
-UCLASS()
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVaroniaFleetChanged, const TArray<int32>&, ChangedDeviceIDs);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVaroniaBPReady, AActor*, VaroniaActor);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVaroniaConfigFieldChanged, FName, FieldName);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnVaroniaSpatialPatched);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVaroniaBoundaryCrossed, const FVaroniaBoundaryCrossing&, Crossing);
+
+UCLASS(Config = Game)
 class VARONIABACKOFFICE_API UVaroniaBackOfficeManager : public UGameInstanceSubsystem
 {
     GENERATED_BODY()
@@ -22,18 +43,50 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Varonia|Config")
     bool LoadLBEConfig();
 
+    /** LoadLBEConfig from an explicit path instead of the Varonia AppData folder (tools, benchmarks) */
+    bool LoadLBEConfigFromFile(const FString& FilePath);
+
     UPROPERTY(BlueprintReadWrite, Category = "Varonia|Config")
     bool GameStarted;
 
-    UPROPERTY(BlueprintReadWrite, Category = "Varonia|Config")
-    ESoftState CurrentSoftState = ESoftState::GAME_LAUNCHED;
+    UFUNCTION(BlueprintGetter)
+    ESoftState GetSoftState() const { return CurrentSoftState; }
+
+    UFUNCTION(BlueprintSetter)
+    void SetSoftState(ESoftState NewState) { TrySetSoftState(NewState); }
+
+    /** False if the state is unchanged or the transition is not allowed */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Config")
+    bool TrySetSoftState(ESoftState NewState);
+
+    UFUNCTION(BlueprintPure, Category = "Varonia|Config")
+    TArray<FVaroniaSoftStateMetrics> GetSoftStateMetrics() const;
+
+    /** C++ entry/exit hooks, e.g. SoftStateMachine.OnEnter(ESoftState::GAME_INPARTY).AddUObject(...) */
+    FVaroniaSoftStateMachine SoftStateMachine;
 
     UPROPERTY(BlueprintReadOnly, Category = "Varonia|Config")
     FLBEConfig CurrentConfig;
 
+    /** Fired once per FLBEConfig field changed by a back office patch (Varonia/Config topics) */
+    UPROPERTY(BlueprintAssignable, Category = "Varonia|Config")
+    FOnVaroniaConfigFieldChanged OnConfigFieldChanged;
+
+    /** Highest config patch version applied from either config topic, 0 if none */
+    UFUNCTION(BlueprintPure, Category = "Varonia|Config")
+    int64 GetConfigVersion() const { return FMath::Max(AppliedConfigVersion, AppliedConfigAllVersion); }
+
     UPROPERTY(BlueprintReadOnly, Category = "Varonia|Config")
     AActor* Varonia_BP = nullptr;
 
+    /** Fired when Varonia_BP has been spawned in a game world (nullptr if BP_Varonia failed to load in time) */
+    UPROPERTY(BlueprintAssignable, Category = "Varonia|Config")
+    FOnVaroniaBPReady OnVaroniaBPReady;
+
+    /** Seconds a world waits for BP_Varonia to finish streaming before the spawn is abandoned (DefaultGame.ini) */
+    UPROPERTY(Config)
+    float VaroniaClassLoadTimeout = 10.f;
+
 
     UPROPERTY(BlueprintReadOnly, Category = "Varonia|MQTT")
     UVaroniaMqttClient* MqttHandler = nullptr;
@@ -45,12 +98,26 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Varonia|Spatial")
     bool LoadSpatialConfig();
 
+    /** LoadSpatialConfig from an explicit path instead of the Varonia AppData folder (tools, benchmarks) */
+    bool LoadSpatialConfigFromFile(const FString& FilePath);
+
+    /** %USERPROFILE%/AppData/LocalLow/Varonia/NewSpatial.json */
+    static FString GetSpatialPath();
+
+    /** Parse NewSpatial.json content, converting Unity coordinates to Unreal */
+    static bool ParseSpatialConfig(const FString& JsonString, FSpatialConfig& OutConfig);
+    static void ParseSpatialBoundary(const TSharedPtr<FJsonObject>& BObj, FSpatialBoundary& Boundary);
+
     UPROPERTY(BlueprintReadOnly, Category = "Varonia|Spatial")
     FSpatialConfig SpatialConfig;
 
     UPROPERTY(BlueprintReadOnly, Category = "Varonia|Spatial")
     bool bSpatialConfigLoaded = false;
 
+    /** SpatialConfig was changed by a back office patch */
+    UPROPERTY(BlueprintAssignable, Category = "Varonia|Spatial")
+    FOnVaroniaSpatialPatched OnSpatialPatched;
+
     // --- Spatial Helpers ---
 
     UFUNCTION(BlueprintPure, Category = "Varonia|Spatial")
@@ -59,12 +126,271 @@ public:
     UFUNCTION(BlueprintPure, Category = "Varonia|Spatial")
     TArray<FSpatialBoundary> GetSubBoundaries() const;
 
+    // --- Placement ---
+
+    /** Minimum distance between placement points and their distance to any boundary edge, in cm (DefaultGame.ini) */
+    UPROPERTY(Config)
+    float PlacementSpacing = 100.f;
+
+    UPROPERTY(Config)
+    float PlacementClearance = 50.f;
+
+    /** Random valid spawn/placement location on the floor of the play area */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Spatial")
+    bool GetRandomPlacementPoint(FVector& OutPoint) const { return Placement.GetRandom(OutPoint); }
+
+    /** Closest valid placement location to Location (XY distance) */
+    UFUNCTION(BlueprintPure, Category = "Varonia|Spatial")
+    bool GetNearestPlacementPoint(const FVector& Location, FVector& OutPoint) const { return Placement.GetNearest(Location, OutPoint); }
+
+    UFUNCTION(BlueprintPure, Category = "Varonia|Spatial")
+    const TArray<FVector>& GetPlacementPoints() const { return Placement.GetPoints(); }
+
+    // --- Boundary Crossings ---
+
+    /** How far past a sub-zone edge (cm) a device must go before it counts as in / out (DefaultGame.ini) */
+    UPROPERTY(Config)
+    float BoundaryHysteresis = 5.f;
+
+    /**
+     * A device entered or left a sub-zone. Tracked and remote poses are tested at the rate they
+     * arrive; events are delivered at the next tick, in order per device, with the crossing time.
+     */
+    UPROPERTY(BlueprintAssignable, Category = "Varonia|Spatial")
+    FOnVaroniaBoundaryCrossed OnBoundaryCrossed;
+
+    // --- Occupancy ---
+
+    /** Heatmap bin size and the distance to a boundary edge that counts as contact, in cm (DefaultGame.ini) */
+    UPROPERTY(Config)
+    float HeatmapCellSize = 25.f;
+
+    UPROPERTY(Config)
+    float HeatmapContactDistance = 30.f;
+
+    /** Every HeatmapDecayInterval seconds the heatmap is scaled by HeatmapDecayFactor (1 = no decay) */
+    UPROPERTY(Config)
+    float HeatmapDecayInterval = 60.f;
+
+    UPROPERTY(Config)
+    float HeatmapDecayFactor = 0.95f;
+
+    /** Add a tracked position (cm). Local and remote poses are recorded automatically. */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Occupancy")
+    void RecordOccupancy(const FVector& Location) { Heatmap.AddSample(Location); }
+
+    /** Samples recorded within HeatmapContactDistance of each boundary, by boundary ID */
+    UFUNCTION(BlueprintPure, Category = "Varonia|Occupancy")
+    TMap<FString, int32> GetBoundaryContacts() const;
+
+    /** Write <BasePath>.png and <BasePath>.vhm (default Saved/Varonia/Heatmaps/<date>); done automatically at session end */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Occupancy")
+    bool ExportHeatmap(const FString& BasePath = TEXT(""));
+
+    // --- Remote Poses ---
+
+    /** Publish this device's pose for spectators (call once per frame on players) */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Poses")
+    void PublishLocalPose(const FTransform& Pose);
+
+    /** Smoothed pose of a remote device for the current frame (spectator modes only) */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Poses")
+    bool SampleRemotePose(int32 DeviceID, FTransform& OutPose);
+
+    UFUNCTION(BlueprintPure, Category = "Varonia|Poses")
+    TArray<int32> GetRemotePoseDevices() const;
+
+    UFUNCTION(BlueprintPure, Category = "Varonia|Poses")
+    FVaroniaJitterStats GetRemotePoseStats(int32 DeviceID) const;
+
+    // --- Tracked Poses ---
+
+    /** How many devices can submit tracked poses (any device IDs); further devices are logged and ignored */
+    static constexpr int32 MaxTrackedDevices = 256;
+
+    /**
+     * Any thread, at tracking rate: newest pose of a device. One producer thread per device;
+     * the pose handoff is lock-free and every sample is tested for boundary crossings. Latched
+     * at the start of each manager tick, where the pose of this device (MQTT_IDClient) is then
+     * published like PublishLocalPose.
+     * Producers must be stopped before the game instance shuts down.
+     */
+    void SubmitTrackedPose(int32 DeviceID, const FTransform& Pose, double Timestamp);
+
+    /**
+     * Game thread: pose latched for this frame. bLateLatch first takes any sample submitted
+     * since the tick, for checks that want the freshest pose (boundaries, fades).
+     */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Poses")
+    bool GetTrackedPose(int32 DeviceID, FTransform& OutPose, bool bLateLatch = false);
+
+    // --- Clock Sync ---
+
+    /**
+     * Device that answers clock sync requests (DefaultGame.ini). -1: the live server device with the
+     * lowest MQTT_IDClient, so several servers never mix their clocks; other servers sync to it like clients.
+     */
+    UPROPERTY(Config)
+    int32 TimeServerID = -1;
+
+    /** Current time on the time server clock (seconds). The time server returns its own clock with a zero bound. */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Time")
+    double GetSyncedTime(double& OutErrorBound) const;
+
+    /** Local clock -> server clock, e.g. to convert a timestamp taken earlier */
+    UFUNCTION(BlueprintPure, Category = "Varonia|Time")
+    double LocalToSyncedTime(double LocalTime) const;
+
+    UFUNCTION(BlueprintPure, Category = "Varonia|Time")
+    bool IsClockSynced() const;
+
+    // --- Fleet (server modes) ---
+
+    /** Fired at most once per frame with every device whose row changed */
+    UPROPERTY(BlueprintAssignable, Category = "Varonia|Fleet")
+    FOnVaroniaFleetChanged OnFleetChanged;
+
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Fleet")
+    TArray<FVaroniaFleetEntry> GetFleetSnapshot() { return Fleet.GetSnapshot(); }
+
+    /** Same as GetFleetSnapshot without the copy; valid until the next frame */
+    const TArray<FVaroniaFleetEntry>& GetFleetSnapshotRef() { return Fleet.GetSnapshot(); }
+
+    UFUNCTION(BlueprintPure, Category = "Varonia|Fleet")
+    bool GetFleetEntry(int32 DeviceID, FVaroniaFleetEntry& OutEntry) const { return Fleet.GetEntry(DeviceID, OutEntry); }
+
+    // --- Frame Budget ---
+
+    /** Game-thread time per frame for scheduled Varonia work, in microseconds (DefaultGame.ini) */
+    UPROPERTY(Config)
+    float FrameBudgetUs = 1000.f;
+
+    /** C++ work that should respect the budget, e.g. Scheduler.AddTask(TEXT("MyGame.Sync"), EVaroniaTaskPriority::Low, 200.f, ...) */
+    FVaroniaFrameScheduler Scheduler;
+
+    UFUNCTION(BlueprintPure, Category = "Varonia|Scheduler")
+    FVaroniaSchedulerStats GetSchedulerStats() const { return Scheduler.GetStats(); }
+
+    // --- Device Status ---
+
+    /** Report this device's status; only changed fields are sent, at most 4 times per second */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|Status")
+    void UpdateDeviceStatus(const FVaroniaDeviceStatus& Status);
+
+    /** Latest status mirrored from another device (server modes) */
+    UFUNCTION(BlueprintPure, Category = "Varonia|Status")
+    bool GetDeviceStatus(int32 DeviceID, FVaroniaDeviceStatus& OutStatus) const;
+
 private:
     FString GetConfigPath();
-    FString GetSpatialPath();
+
+    // Remote config: fields are merged into GlobalConfig.json in the background, a second after
+    // the last patch; spatial patches are journaled next to the spatial file and replayed on load.
+    // Config/<ID> and Config/All are versioned independently, the broker replays them in any order
+    void HandleConfigPatch(const TArray<uint8>& Payload, bool bAllDevices);
+    void FlushConfigWrites();
+    void AppendSpatialJournal(const TSharedPtr<FJsonObject>& SpatialPatch, int64 Version, bool bAllDevices);
+    void ReplaySpatialJournal(const FString& FilePath);
+
+    int64 AppliedConfigVersion = 0;
+    int64 AppliedConfigAllVersion = 0;
+    FString SpatialFilePath;
+    TMap<FString, TSharedPtr<FJsonValue>> PendingConfigWrites;
+    double ConfigWriteTime = 0.0;
+    UE::Tasks::FTask ConfigWriteTask;
 
     void OnWorldCreated(UWorld* World, const UWorld::InitializationValues IValues);
 
+    // BP_Varonia is streamed once at init and cached; worlds created before it lands wait here
+    struct FPendingVaroniaSpawn
+    {
+        TWeakObjectPtr<UWorld> World;
+        double Deadline = 0.0;
+    };
+
+    void CreateMqttHandler();
+
+    void RequestVaroniaClass();
+    void OnVaroniaClassLoaded();
+    void FailPendingVaroniaSpawns();
+    void SpawnVaroniaBP(UWorld* World);
+
+    UPROPERTY()
+    TSubclassOf<AActor> VaroniaClass;
+
+    TSharedPtr<FStreamableHandle> VaroniaClassHandle;
+    FStreamableManager StandaloneStreamable;
+    TArray<FPendingVaroniaSpawn> PendingVaroniaSpawns;
+    double VaroniaClassRequestTime = 0.0;
+
+    double StartupTraceDeadline = 0.0;
+
+    bool Tick(float DeltaTime);
+    FTSTicker::FDelegateHandle TickerHandle;
+
+    void HandleMqttMessage(const FString& Topic, const TArray<uint8>& Payload);
+    bool IsSpectator() const;
+    bool IsServer() const;
+    bool IsTimeServer() const;
+    int32 ElectTimeServer() const;
+
+    /** Other server devices by ID, with the last time they announced themselves */
+    TMap<int32, double> TimeServersSeen;
+
+    /** Time server the ClockSync window was filled against, re-elected every tick */
+    int32 ClockServerID = INDEX_NONE;
+
+    void SendTimeRequest();
+    void HandleTimeRequest(const TArray<uint8>& Payload);
+    void HandleTimeReply(const TArray<uint8>& Payload);
+
+    FVaroniaClockSync ClockSync;
+    double NextTimeRequest = 0.0;
+
+    UFUNCTION()
+    void HandleMqttConnected();
+
+    /** Private so every write goes through TrySetSoftState: validated against the transition table and published on change */
+    UPROPERTY(BlueprintGetter = GetSoftState, BlueprintSetter = SetSoftState, Category = "Varonia|Config", meta = (AllowPrivateAccess = "true"))
+    ESoftState CurrentSoftState = ESoftState::GAME_LAUNCHED;
+
+    /** Publish CurrentSoftState unless the broker already has this value from us */
+    void PublishSoftState();
+    int32 LastPublishedSoftState = -1;
+
+    void SendHeartbeat();
+    void HandleStatusMessage(const TArray<uint8>& Payload);
+
+    FVaroniaFleetTable Fleet;
+    TArray<int32> FleetChanges;
+    TMap<int32, EVaroniaDeviceHealth> JournaledHealth;
+    double NextHeartbeat = 0.0;
+
+    FVaroniaPlacementPoints Placement;
+    FVaroniaOccupancyHeatmap Heatmap;
+    double NextHeatmapDecay = 0.0;
+
+    FVaroniaBoundaryCrossings Crossings;
+    TArray<FVaroniaBoundaryCrossing> CrossingEvents;
+    void DispatchBoundaryCrossings();
+
+    /** Jitter buffer per remote device ID */
+    TMap<int32, FVaroniaPoseJitterBuffer> RemotePoses;
+
+    /** MaxTrackedDevices triple buffers, allocated once; read only from the game thread */
+    TUniquePtr<TVaroniaTripleBuffer<FVaroniaTrackedPose>[]> TrackedPoses;
+
+    /** Device ID owning each TrackedPoses slot (INDEX_NONE = free). Claimed on first submit, never released. */
+    TUniquePtr<std::atomic<int32>[]> TrackedDeviceIDs;
+    std::atomic<bool> bTrackedPosesFullLogged { false };
+
+    /** Open addressing on the device ID; lock-free, so tracker threads can claim concurrently */
+    int32 FindTrackedSlot(int32 DeviceID, bool bClaim);
+    void LatchTrackedPoses();
+
+    /** Timestamp of the last tracked local pose sent; a late latch may have taken the sample since */
+    double LastPublishedTrackedTime = 0.0;
+
     static FVector UnityToUnreal(float X, float Y, float Z);
     static FRotator UnityQuatToUnrealRotator(float X, float Y, float Z, float W);
   virtual void Deinitialize() override;
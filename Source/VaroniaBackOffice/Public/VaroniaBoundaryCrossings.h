@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Misc/ScopeRWLock.h"
+#include "LBE_Types.h"
+
+/**
+ * Enter / exit events for sub-zone boundaries (every boundary but the main one), per device.
+ *
+ * Each pose is joined to the previous pose of its device and that segment is tested against the
+ * edges of the zones whose bounds it overlaps, so a fast walk through a door between two samples
+ * is still seen, with an interpolated crossing time. A side change only counts once the path gets
+ * Hysteresis cm past the edge, so standing on the line does not flicker.
+ *
+ * AddPose may be called from any thread: each device's state has its own lock, so a device fed
+ * by one thread (its tracker thread, or the game thread for remote poses) never waits. Events of
+ * a device are queued in the order they happened and read on the game thread with ConsumeEvents.
+ * Device IDs follow the fleet table range, [0, FVaroniaFleetTable::MaxDeviceID).
+ */
+class VARONIABACKOFFICE_API FVaroniaBoundaryCrossings
+{
+public:
+    /** Game thread. Replaces the zones; every device starts over from its next pose, without events. */
+    void Build(const FSpatialConfig& Config, float InHysteresis);
+
+    /** Location in Unreal cm, Time in seconds on the clock of the pose source */
+    void AddPose(int32 DeviceID, const FVector& Location, double Time);
+
+    /** Game thread: events queued since the last call */
+    void ConsumeEvents(TArray<FVaroniaBoundaryCrossing>& OutEvents);
+
+private:
+    struct FZone
+    {
+        FString ID;
+        TArray<FVector> Points;
+
+        /** Polygon bounds grown by Hysteresis: the broad phase */
+        FBox2D Bounds;
+    };
+
+    struct FZoneState
+    {
+        /** Last reported side */
+        bool bInside = false;
+
+        /** Geometric side of the last pose; differs from bInside while inside the hysteresis band */
+        bool bSide = false;
+
+        /** Time of the crossing that left bInside, reported once the hysteresis is passed */
+        double PendingTime = 0.0;
+    };
+
+    struct FDeviceState
+    {
+        FCriticalSection Mutex;
+        FVector2D Last = FVector2D::ZeroVector;
+        double LastTime = 0.0;
+        bool bValid = false;
+        TArray<FZoneState> Zones;
+    };
+
+    TArray<FZone> Zones;
+    double Hysteresis = 5.0;
+
+    /** Added on a device's first pose and kept; entries do not move when the map grows */
+    TMap<int32, TUniquePtr<FDeviceState>> Devices;
+
+    /** Guards Zones and the Devices map: pose threads read, Build and new devices write */
+    FRWLock ZonesLock;
+
+    TQueue<FVaroniaBoundaryCrossing, EQueueMode::Mpsc> Events;
+
+    void UpdateDevice(int32 DeviceID, FDeviceState& Device, const FVector2D& P, double Time);
+    void Sweep(int32 DeviceID, const FZone& Zone, FZoneState& State, const FVector2D& A, double TimeA, const FVector2D& B, double TimeB);
+    void Commit(int32 DeviceID, const FZone& Zone, FZoneState& State);
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Time request (device -> server) and reply (server -> device) as sent on VaroniaMqttTopics::Time* */
+struct VARONIABACKOFFICE_API FVaroniaTimeMessage
+{
+    int32 DeviceID = 0;
+
+    /** Answering time server, so a device only fits replies from the server it elected; unused in requests */
+    int32 ServerID = INDEX_NONE;
+
+    /** Device send time (T1) */
+    double OriginTime = 0.0;
+
+    /** Server receive / transmit times (T2 / T3), unused in requests */
+    double ReceiveTime = 0.0;
+    double TransmitTime = 0.0;
+
+    void Encode(TArray<uint8>& OutBytes) const;
+    static bool Decode(const TArray<uint8>& Bytes, FVaroniaTimeMessage& OutMessage);
+};
+
+/**
+ * NTP-style offset/drift estimator against the server device clock.
+ * Keeps a window of exchanges, fits offset = a + b * t over the lowest-delay half
+ * (least squares) and derives an error bound from the best round trip and the fit residual.
+ */
+class VARONIABACKOFFICE_API FVaroniaClockSync
+{
+public:
+    static constexpr int32 WindowSize = 64;
+
+    /** Exchanges needed before the estimate is trusted */
+    static constexpr int32 MinSamples = 8;
+
+    /** Feed one completed exchange (T1..T4, T2/T3 in server time) */
+    void AddExchange(double T1, double T2, double T3, double T4);
+
+    /** Local clock -> server clock */
+    double ToServerTime(double LocalTime) const;
+
+    bool IsSynced() const { return NumSamples >= MinSamples; }
+
+    /** Half-width of the confidence interval of ToServerTime, seconds */
+    double GetErrorBound() const { return ErrorBound; }
+
+    /** Estimated drift of the local clock against the server, parts per million */
+    double GetDriftPpm() const { return Drift * 1e6; }
+
+    /** Poll fast until synced, then settle to a slow refresh */
+    double GetRequestInterval() const { return IsSynced() ? 2.0 : 0.2; }
+
+    void Reset();
+
+private:
+    struct FExchange
+    {
+        double LocalTime = 0.0;
+        double Offset = 0.0;
+        double Delay = 0.0;
+    };
+
+    FExchange Window[WindowSize];
+    int32 NextSample = 0;
+    int32 NumSamples = 0;
+
+    double ReferenceTime = 0.0;
+    double Offset = 0.0;
+    double Drift = 0.0;
+    double ErrorBound = DBL_MAX;
+
+    void Solve();
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LBE_Types.h"
+
+class FJsonObject;
+class FJsonValue;
+
+/**
+ * Versioned partial update pushed by the back office on "Varonia/Config/<DeviceID>" or "Varonia/Config/All":
+ *
+ *   { "Version": 12,
+ *     "Config":  { "PlayerName": "Alice", "MainHand": 0 },
+ *     "Spatial": { "Name": "Arena B", "Boundaries": [ { "ID": "Boundary0", ... } ], "RemoveBoundaries": [ "Boundary3" ] } }
+ *
+ * Config keys are FLBEConfig property names; Spatial uses the NewSpatial.json layout, boundaries are
+ * replaced (or added) by ID. Both sections are optional. Apply works on a copy and only writes back
+ * when the whole section parsed, so a bad patch never leaves a half-updated config.
+ */
+struct VARONIABACKOFFICE_API FVaroniaConfigPatch
+{
+    int64 Version = 0;
+    TSharedPtr<FJsonObject> Config;
+    TSharedPtr<FJsonObject> Spatial;
+
+    static bool Parse(const TArray<uint8>& Payload, FVaroniaConfigPatch& OutPatch);
+
+    /** OutChanged receives the fields whose value actually changed */
+    bool ApplyConfig(FLBEConfig& InOutConfig, TArray<FName>& OutChanged, FString& OutError) const;
+
+    static bool ApplySpatial(const FJsonObject& SpatialPatch, FSpatialConfig& InOutConfig, FString& OutError);
+
+    /** Connection and role fields, read once at launch (MQTT subscriptions, IsServer); patches only persist them */
+    static bool IsLaunchOnlyField(FName Field);
+
+    /** Field value as GlobalConfig.json stores it (enums as numbers) */
+    static TSharedPtr<FJsonValue> ConfigFieldToJson(FName Field, const FLBEConfig& Config);
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LBE_Types.h"
+#include "VaroniaFleetTable.generated.h"
+
+UENUM(BlueprintType)
+enum class EVaroniaDeviceHealth : uint8 {
+    Online = 0,
+    Stale = 1,
+    Offline = 2
+};
+
+/** One row of the fleet table, as handed to UI */
+USTRUCT(BlueprintType)
+struct FVaroniaFleetEntry {
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Fleet")
+    int32 DeviceID = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Fleet")
+    ESoftState SoftState = ESoftState::UNKNOWN;
+
+    /** FPlatformTime::Seconds() of the last message from this device */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Fleet")
+    double LastSeen = 0.0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Fleet")
+    FString PlayerName;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Fleet")
+    EVaroniaDeviceHealth Health = EVaroniaDeviceHealth::Online;
+};
+
+/**
+ * Session-wide device table kept by server devices.
+ * Columns are dense arrays indexed by slot; a flat DeviceID -> slot array gives O(1) lookup
+ * without hashing. Changes are collected as a dirty list and consumed once per frame.
+ */
+class VARONIABACKOFFICE_API FVaroniaFleetTable
+{
+public:
+    /** Device IDs are MQTT_IDClient values; anything outside [0, MaxDeviceID) is ignored */
+    static constexpr int32 MaxDeviceID = 65536;
+
+    /** Silence before a device is reported Stale / Offline (seconds) */
+    double StaleAfter = 3.0;
+    double OfflineAfter = 10.0;
+
+    void MarkSeen(int32 DeviceID, double Now);
+    void SetSoftState(int32 DeviceID, ESoftState State);
+    void SetPlayerName(int32 DeviceID, const FString& PlayerName);
+
+    /** Re-evaluate health from last-seen times */
+    void UpdateHealth(double Now);
+
+    /** Device IDs changed since the last call; false if nothing changed */
+    bool ConsumeChanges(TArray<int32>& OutDeviceIDs);
+
+    /** Cached rows, rebuilt only when something changed since the previous call */
+    const TArray<FVaroniaFleetEntry>& GetSnapshot();
+
+    bool GetEntry(int32 DeviceID, FVaroniaFleetEntry& OutEntry) const;
+
+    int32 Num() const { return DeviceIDs.Num(); }
+
+    void Reset();
+
+private:
+    /** DeviceID -> slot, INDEX_NONE when unknown; grown on demand */
+    TArray<int32> SlotOfDevice;
+
+    // Columns (one element per slot)
+    TArray<int32> DeviceIDs;
+    TArray<ESoftState> SoftStates;
+    TArray<double> LastSeen;
+    TArray<FString> PlayerNames;
+    TArray<EVaroniaDeviceHealth> Health;
+    TBitArray<> Dirty;
+
+    TArray<int32> DirtySlots;
+
+    uint32 Version = 0;
+    uint32 SnapshotVersion = MAX_uint32;
+    TArray<FVaroniaFleetEntry> Snapshot;
+
+    int32 FindSlot(int32 DeviceID) const;
+    int32 FindOrAddSlot(int32 DeviceID);
+    void MarkDirty(int32 Slot);
+};
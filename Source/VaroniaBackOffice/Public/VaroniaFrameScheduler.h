@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VaroniaFrameScheduler.generated.h"
+
+UENUM(BlueprintType)
+enum class EVaroniaTaskPriority : uint8 {
+    Critical, // Runs every frame whatever the budget
+    High,
+    Normal,
+    Low
+};
+
+USTRUCT(BlueprintType)
+struct FVaroniaSchedulerStats
+{
+    GENERATED_BODY()
+
+    /** Microseconds spent in scheduled work last frame */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Scheduler")
+    float LastFrameUs = 0.f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Scheduler")
+    int32 LastFrameRan = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Scheduler")
+    int32 LastFrameDeferred = 0;
+
+    /** Tasks pushed to a later frame since startup */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Scheduler")
+    int64 TotalDeferred = 0;
+
+    /** Frames whose scheduled work exceeded the budget */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Scheduler")
+    int64 TotalOverruns = 0;
+};
+
+/**
+ * Per-frame game-thread budget for Varonia work.
+ *
+ * Tasks run highest priority first while their estimated cost still fits in the budget; the rest
+ * wait for the next frame. A task that waited gains one priority level per AgingFrames so Low work
+ * cannot starve, and anything deferred MaxDeferFrames in a row runs regardless. Cost estimates are
+ * refined from measured run times.
+ *
+ * A task receives the time its slice ends (FPlatformTime::Seconds) and returns true to stay
+ * scheduled: recurring work always returns true, time-sliced work returns true until done.
+ */
+class VARONIABACKOFFICE_API FVaroniaFrameScheduler
+{
+public:
+    using FTaskFunction = TFunction<bool(double SliceEnd)>;
+
+    int32 AddTask(const TCHAR* Name, EVaroniaTaskPriority Priority, float EstimatedCostUs, FTaskFunction Function);
+    void RemoveTask(int32 Handle);
+
+    void Run();
+
+    const FVaroniaSchedulerStats& GetStats() const { return Stats; }
+
+    float BudgetUs = 1000.f;
+    int32 AgingFrames = 4;
+    int32 MaxDeferFrames = 30;
+
+private:
+    struct FTask
+    {
+        int32 Handle = 0;
+        const TCHAR* Name = nullptr;
+        EVaroniaTaskPriority Priority = EVaroniaTaskPriority::Normal;
+        float CostUs = 0.f;
+        int32 FramesDeferred = 0;
+        FTaskFunction Function;
+    };
+
+    TArray<FTask> Tasks;
+    TArray<int32> Order;
+    FVaroniaSchedulerStats Stats;
+    int32 NextHandle = 1;
+    bool bRunning = false;
+
+    /** Changes requested from inside Run, applied once the loop is done (Tasks must not move under it) */
+    TArray<FTask> PendingAdds;
+    TArray<int32> PendingRemovals;
+};
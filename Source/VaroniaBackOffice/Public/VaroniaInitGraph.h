@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+
+enum class EVaroniaInitThread : uint8 {
+    /** Runs on a task worker as soon as its dependencies are done */
+    Worker,
+    /** Runs on the thread that calls Run() (UObject creation, async load requests) */
+    GameThread
+};
+
+/**
+ * Small dependency graph for subsystem initialisation.
+ * Steps must be added after their dependencies, so insertion order is a valid topological order.
+ * Run() blocks until every step finished and records per-step timings for LogReport().
+ */
+class VARONIABACKOFFICE_API FVaroniaInitGraph
+{
+public:
+    void AddStep(const TCHAR* Name, TArray<const TCHAR*> Dependencies, EVaroniaInitThread Thread, TFunction<void()> Work);
+
+    void Run();
+
+    /** Per-step timings, the critical path through the graph, and wall time vs. serial time */
+    void LogReport() const;
+
+private:
+    struct FStep
+    {
+        const TCHAR* Name = nullptr;
+        TArray<int32> Dependencies;
+        EVaroniaInitThread Thread = EVaroniaInitThread::Worker;
+        TFunction<void()> Work;
+        double Start = 0.0;
+        double End = 0.0;
+    };
+
+    TArray<FStep> Steps;
+    double RunStart = 0.0;
+    double RunEnd = 0.0;
+
+    void Execute(FStep& Step);
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+
+/** Event IDs are stored in journal files: append only, never renumber */
+enum class EVaroniaJournalEvent : uint16 {
+    JournalStarted      = 0,  // A = process ID
+    ConfigLoaded        = 1,  // A = MQTT_IDClient, B = DeviceMode
+    ConfigDefaulted     = 2,  // GlobalConfig.json missing or unreadable
+    ConfigPatched       = 3,  // A = version, B = changed field count
+    SpatialLoaded       = 4,  // A = boundary count
+    SoftStateChanged    = 5,  // A = from, B = to
+    SoftStateRejected   = 6,  // A = from, B = requested
+    MqttConnecting      = 7,  // A = client ID, B = port
+    MqttConnected       = 8,  // A = handshake µs
+    MqttDisconnected    = 9,
+    MqttError           = 10, // A = error code
+    ClockSynced         = 11, // A = error bound µs, B = drift ppb
+    DeviceHealthChanged = 12, // A = device ID, B = EVaroniaDeviceHealth
+    SpawnTimedOut       = 13, // A = timeout ms
+    BoundaryEntered     = 14, // A = device ID, B = boundary index
+    BoundaryExited      = 15, // A = device ID, B = boundary index
+};
+
+/** One journal entry, written as is (little endian) */
+struct FVaroniaJournalRecord
+{
+    /** Microseconds since the file's start time */
+    uint64 TimeUs = 0;
+    uint32 ThreadId = 0;
+    uint16 Event = 0;
+    uint16 Reserved = 0;
+    int64 A = 0;
+    int64 B = 0;
+};
+static_assert(sizeof(FVaroniaJournalRecord) == 32, "Journal records are fixed size on disk");
+
+/**
+ * Binary event journal for production diagnostics.
+ *
+ * Record() is a couple of stores into a per-thread ring; a background thread drains the rings every
+ * 100 ms into Saved/Logs/Varonia/Journal.vjl, rolling to Journal.1.vjl .. Journal.<MaxFiles-1>.vjl.
+ * Records are dropped (and counted) if a thread outruns the flush. Disabled with -NoVaroniaJournal.
+ *
+ * File: "VJRN" | uint16 version | uint16 record size | int64 UTC start ticks | records...
+ * Decode with Varonia.Journal.Dump [path] or FVaroniaJournal::ReadFile.
+ */
+class VARONIABACKOFFICE_API FVaroniaJournal : public FRunnable
+{
+public:
+    static constexpr uint32 Magic = 0x4E524A56; // "VJRN"
+    static constexpr uint16 Version = 1;
+    static constexpr int32 RingSize = 1024;
+    static constexpr int64 MaxFileBytes = 4 * 1024 * 1024;
+    static constexpr int32 MaxFiles = 4;
+
+    static FVaroniaJournal& Get();
+
+    void Start(const FString& InDirectory);
+    void Stop();
+
+    void Record(EVaroniaJournalEvent Event, int64 A = 0, int64 B = 0);
+
+    uint64 GetDroppedCount() const { return Dropped.load(std::memory_order_relaxed); }
+    bool IsRunning() const { return Thread != nullptr; }
+    const FString& GetDirectory() const { return Directory; }
+
+    static bool ReadFile(const FString& Path, FDateTime& OutStart, TArray<FVaroniaJournalRecord>& OutRecords);
+    static FString Describe(const FVaroniaJournalRecord& Record);
+
+    // FRunnable
+    virtual uint32 Run() override;
+
+private:
+    /** Single producer (owning thread), single consumer (flush thread) */
+    struct FThreadRing
+    {
+        FVaroniaJournalRecord Records[RingSize];
+        std::atomic<uint32> Head { 0 };
+        std::atomic<uint32> Tail { 0 };
+    };
+
+    FThreadRing* GetThreadRing();
+    void Drain();
+    void OpenFile();
+
+    TArray<TUniquePtr<FThreadRing>> Rings;
+    FCriticalSection RingsLock;
+
+    std::atomic<bool> bEnabled { false };
+    std::atomic<uint64> Dropped { 0 };
+    uint64 StartCycles = 0;
+
+    FString Directory;
+    TUniquePtr<FArchive> File;
+    TArray<FVaroniaJournalRecord> Block;
+    FRunnableThread* Thread = nullptr;
+    FEvent* WakeEvent = nullptr;
+    std::atomic<bool> bStopping { false };
+};
+
+#define VARONIA_JOURNAL(Event, ...) FVaroniaJournal::Get().Record(EVaroniaJournalEvent::Event, ##__VA_ARGS__)
@@ -5,11 +5,47 @@
 #include "Interface/MqttClientInterface.h"
 #include "Entities/MqttClientConfig.h"
 #include "Entities/MqttConnectionData.h"
+#include "Entities/MqttMessage.h"
+#include "VaroniaStructReplicator.h"
+#include "VaroniaMqttRecorder.h"
+#include "Containers/Ticker.h"
 #include "VaroniaMqttClient.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnVaroniaMqttConnected);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnVaroniaMqttDisconnected);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnVaroniaMqttError, int32, Code, FString, Message);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnVaroniaMqttMessage, FString, Topic, FString, Message);
+
+// Native (C++) message hook — raw payload bytes, no string conversion
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnVaroniaMqttMessageNative, const FString& /*Topic*/, const TArray<uint8>& /*Payload*/);
+
+/** Topic roots used by the native Varonia features */
+namespace VaroniaMqttTopics
+{
+    /** Binary pose stream, published as "Varonia/Pose/<DeviceID>" */
+    inline constexpr const TCHAR* Pose = TEXT("Varonia/Pose");
+
+    /** JSON status messages (FormatMqttMessage), published as "Varonia/Status/<DeviceID>" */
+    inline constexpr const TCHAR* Status = TEXT("Varonia/Status");
+
+    /** Struct delta replication, published as "Varonia/State/<Channel>/<DeviceID>" */
+    inline constexpr const TCHAR* State = TEXT("Varonia/State");
+
+    /** Clock sync requests to the server device */
+    inline constexpr const TCHAR* TimeRequest = TEXT("Varonia/Time/Request");
+
+    /** Server devices announce their int32 ID here every second; one of them answers clock sync requests */
+    inline constexpr const TCHAR* TimeServer = TEXT("Varonia/Time/Server");
+
+    /** Clock sync replies, published as "Varonia/Time/Reply/<DeviceID>" */
+    inline constexpr const TCHAR* TimeReply = TEXT("Varonia/Time/Reply");
+
+    /** Back office config patches, published as "Varonia/Config/<DeviceID>" or "Varonia/Config/All" */
+    inline constexpr const TCHAR* Config = TEXT("Varonia/Config");
+
+    /** File transfers: "Varonia/Upload/Begin|Data|Ack/<TransferID>" (FVaroniaMqttUploader) */
+    inline constexpr const TCHAR* Upload = TEXT("Varonia/Upload");
+}
 
 UCLASS(BlueprintType)
 class VARONIABACKOFFICE_API UVaroniaMqttClient : public UObject
@@ -27,6 +63,16 @@ public:
     UFUNCTION(BlueprintPure, Category = "Varonia|MQTT")
     bool IsConnected() const { return bIsConnected; }
 
+    /** Subscribe to a topic. Subscriptions are kept and replayed on every (re)connect. */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|MQTT")
+    void Subscribe(const FString& Topic, int32 Qos = 0);
+
+    UFUNCTION(BlueprintCallable, Category = "Varonia|MQTT")
+    void Publish(const FString& Topic, const FString& Message, int32 Qos = 0, bool bRetain = false);
+
+    /** Publish a binary payload (dropped silently while disconnected) */
+    void PublishBytes(const FString& Topic, const TArray<uint8>& Payload, int32 Qos = 0, bool bRetain = false);
+
     // Events
     UPROPERTY(BlueprintAssignable, Category = "Varonia|MQTT")
     FOnVaroniaMqttConnected OnConnected;
@@ -37,12 +83,75 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "Varonia|MQTT")
     FOnVaroniaMqttError OnError;
 
+    UPROPERTY(BlueprintAssignable, Category = "Varonia|MQTT")
+    FOnVaroniaMqttMessage OnMessage;
+
+    FOnVaroniaMqttMessageNative OnMessageNative;
+
     UFUNCTION(BlueprintPure, Category = "Varonia|MQTT")
     TScriptInterface<IMqttClientInterface> GetMqttClient() const { return MqttClient; }
 
+    // --- Struct replication ---
+
+    /** Publish changes of a USTRUCT on a channel, field by field, at most MaxRateHz */
+    void RegisterReplicatedStruct(const FString& Channel, const UScriptStruct* Struct, float MaxRateHz = 10.f);
+
+    /** Hand the current value over; it is diffed now and sent on the next TickReplication. Unregistered channels are ignored. */
+    void UpdateReplicatedStruct(const FString& Channel, const void* Data);
+
+    template<typename T>
+    void UpdateReplicatedStruct(const FString& Channel, const T& Value)
+    {
+        const TUniquePtr<FVaroniaStructReplicator>* Replicator = ReplicatedStructs.Find(Channel);
+        if (!Replicator) return;
+
+        check(T::StaticStruct() == (*Replicator)->GetStruct());
+        (*Replicator)->Update(&Value);
+    }
+
+    /** Receive a channel from every device into per-device mirror copies */
+    void MirrorReplicatedStruct(const FString& Channel, const UScriptStruct* Struct);
+
+    /** Mirror copy for one device, nullptr until its first delta arrived */
+    const void* GetMirroredStruct(const FString& Channel, int32 DeviceID) const;
+
+    template<typename T>
+    const T* GetMirroredStruct(const FString& Channel, int32 DeviceID) const
+    {
+        return static_cast<const T*>(GetMirroredStruct(Channel, DeviceID));
+    }
+
+    /** Send pending deltas; call once per frame */
+    void TickReplication(double Now);
+
+    // --- Record / replay ---
+
+    /** Log every message sent and received to a *.vmqr file (empty path = Saved/Varonia/Sessions/<date>.vmqr) */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|MQTT")
+    bool StartRecording(const FString& Path = TEXT(""));
+
+    UFUNCTION(BlueprintCallable, Category = "Varonia|MQTT")
+    void StopRecording();
+
+    /**
+     * Play a recording back. Inbound messages are injected as if they came from the broker,
+     * outbound ones are re-published when bPublishOutbound (load testing a broker / server).
+     * Speed 1 = real time, 0 = as fast as possible.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|MQTT")
+    bool StartReplay(const FString& Path, float Speed = 1.f, bool bPublishOutbound = false);
+
+    UFUNCTION(BlueprintCallable, Category = "Varonia|MQTT")
+    void StopReplay();
+
+    UFUNCTION(BlueprintPure, Category = "Varonia|MQTT")
+    bool IsReplaying() const { return Replayer.IsValid(); }
+
     UPROPERTY(BlueprintReadOnly, Category = "Varonia|MQTT")
     int32 ClientID = 0;
 
+    virtual void BeginDestroy() override;
+
 
 private:
 
@@ -50,6 +159,31 @@ private:
     TScriptInterface<IMqttClientInterface> MqttClient;
 
     bool bIsConnected = false;
+    double ConnectStartTime = 0.0;
+
+    /** Topic -> QoS */
+    TMap<FString, int32> Subscriptions;
+
+    struct FMirrorChannel
+    {
+        const UScriptStruct* Struct = nullptr;
+        TMap<int32, TUniquePtr<FVaroniaStructMirror>> Devices;
+    };
+
+    TMap<FString, TUniquePtr<FVaroniaStructReplicator>> ReplicatedStructs;
+    TMap<FString, FMirrorChannel> MirroredStructs;
+
+    void HandleStateMessage(const FString& Topic, const TArray<uint8>& Payload);
+
+    /** Route a received payload to the native handlers and events */
+    void DispatchMessage(const FString& Topic, const TArray<uint8>& Payload, const FString& Text);
+
+    TUniquePtr<FVaroniaMqttRecorder> Recorder;
+    TUniquePtr<FVaroniaMqttReplayer> Replayer;
+    FTSTicker::FDelegateHandle ReplayTickerHandle;
+    bool bReplayOutbound = false;
+
+    bool TickReplay(float DeltaTime);
 
     UFUNCTION()
     void HandleConnected();
@@ -59,4 +193,7 @@ private:
 
     UFUNCTION()
     void HandleError(int Code, FString Message);
+
+    UFUNCTION()
+    void HandleMessage(FMqttMessage Message);
 };
\ No newline at end of file
@@ -14,6 +14,9 @@ struct FVaroniaMqttItems
 
     UPROPERTY(BlueprintReadWrite, Category = "Varonia")
     int32 SoftState = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Varonia")
+    FString PlayerName;
 };
 
 USTRUCT(BlueprintType)
@@ -41,5 +44,9 @@ class VARONIABACKOFFICE_API UVaroniaMqttLibrary : public UBlueprintFunctionLibra
 
 public:
     UFUNCTION(BlueprintPure, Category = "Varonia|MQTT")
-    static FString FormatMqttMessage(int32 ClientID, FString MethodName, int32 SoftStateValue = -1);
+    static FString FormatMqttMessage(int32 ClientID, FString MethodName, int32 SoftStateValue = -1, const FString& PlayerName = TEXT(""));
+
+    /** Decode a payload built by FormatMqttMessage. Items.SoftState is -1 when the message carried none. */
+    UFUNCTION(BlueprintCallable, Category = "Varonia|MQTT")
+    static bool ParseMqttMessage(const FString& Message, FVaroniaMqttPayload& OutPayload);
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+
+enum class EVaroniaMqttDirection : uint8 {
+    Inbound = 1,
+    Outbound = 2
+};
+
+/**
+ * Append-only binary log of MQTT traffic (*.vmqr).
+ *
+ *   Header  : "VMQR" | uint16 version | uint16 reserved | int64 UTC start ticks
+ *   Topic   : uint8 0 | uint16 index | uint16 length | UTF-8 bytes     (first use of a topic)
+ *   Message : uint8 direction | uint32 µs since previous record | uint16 topic index | uint32 length | payload
+ *
+ * Records are appended to a memory block on the calling thread and written by a background task
+ * once the block reaches FlushThreshold, so recording costs a memcpy per message.
+ */
+class VARONIABACKOFFICE_API FVaroniaMqttRecorder
+{
+public:
+    static constexpr uint32 Magic = 0x52514D56; // "VMQR"
+    static constexpr uint16 Version = 1;
+    static constexpr int32 FlushThreshold = 64 * 1024;
+
+    ~FVaroniaMqttRecorder();
+
+    bool Open(const FString& Path);
+
+    /** Flush everything and close the file (blocks until written) */
+    void Close();
+
+    bool IsOpen() const { return File.IsValid(); }
+
+    void Record(EVaroniaMqttDirection Direction, const FString& Topic, const TArray<uint8>& Payload);
+
+private:
+    TSharedPtr<FArchive, ESPMode::ThreadSafe> File;
+    TArray<uint8> Pending;
+    TMap<FString, uint16> TopicIndices;
+    double LastRecordTime = 0.0;
+    UE::Tasks::FTask LastFlush;
+
+    void Flush();
+};
+
+/** Streams a *.vmqr log back, delivering records when their (scaled) time has come */
+class VARONIABACKOFFICE_API FVaroniaMqttReplayer
+{
+public:
+    /** 1 = real time, 4 = four times faster, 0 = as fast as possible */
+    bool Open(const FString& Path, float InSpeed);
+
+    /** Deliver every due record; false once the log is exhausted */
+    bool Tick(double Now, TFunctionRef<void(EVaroniaMqttDirection, const FString&, const TArray<uint8>&)> Deliver);
+
+private:
+    TUniquePtr<FArchive> File;
+    TArray<FString> Topics;
+    float Speed = 1.f;
+    double StartTime = 0.0;
+
+    /** Log time of the next record, seconds since the first one */
+    double NextRecordTime = 0.0;
+
+    bool bHasNext = false;
+    EVaroniaMqttDirection NextDirection = EVaroniaMqttDirection::Inbound;
+    uint16 NextTopic = 0;
+    TArray<uint8> NextPayload;
+
+    /** Read up to the next message record (consuming topic definitions) */
+    bool ReadNext();
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+class UVaroniaMqttClient;
+
+/**
+ * Sends files to the back office over MQTT in fixed-size chunks, one file at a time.
+ *
+ *   Begin : "Varonia/Upload/Begin/<ID>"  JSON { Name, Size, ChunkSize, ChunkCount, Sender }
+ *   Data  : "Varonia/Upload/Data/<ID>"   "VUPC" | uint32 index | uint32 count | uint32 size | uint32 CRC32 | payload
+ *   Ack   : "Varonia/Upload/Ack/<ID>"    JSON { Next, Error }   (Next = first chunk not yet stored)
+ *
+ * Chunks are read from disk as they are sent, at most Window of them ahead of the last ack, at QoS 1.
+ * The ID derives from the name, size and timestamp of the file, so the back office keeps partial
+ * data across disconnects and restarts: Begin is sent again on every (re)connect and sending resumes
+ * from the Next it answers. Without progress for AckTimeout, unacked chunks are sent again.
+ */
+class VARONIABACKOFFICE_API FVaroniaMqttUploader
+{
+public:
+    static constexpr uint32 ChunkMagic = 0x43505556; // "VUPC"
+
+    explicit FVaroniaMqttUploader(UVaroniaMqttClient* InClient, int32 InChunkSize = 64 * 1024, int32 InWindow = 8);
+    ~FVaroniaMqttUploader();
+
+    /** Queue a file, or every file below a directory (tile pyramids) named RemoteName/<relative path> */
+    bool Enqueue(const FString& Path, const FString& RemoteName);
+
+    bool IsIdle() const { return Queue.IsEmpty(); }
+    int32 GetNumFailed() const { return NumFailed; }
+
+    DECLARE_MULTICAST_DELEGATE_TwoParams(FOnFileDone, const FString& /*RemoteName*/, bool /*bSuccess*/);
+    FOnFileDone OnFileDone;
+
+    double AckTimeout = 5.0;
+    int32 MaxRetries = 10;
+
+private:
+    struct FTransfer
+    {
+        FString Path;
+        FString Name;
+        FString ID;
+        int64 Size = 0;
+        int32 ChunkCount = 0;
+
+        int32 Acked = 0;
+        int32 NextToSend = 0;
+
+        /** Begin is sent per connection; until answered we do not know where to resume */
+        bool bBegun = false;
+        bool bAwaitingResume = false;
+        double LastProgress = 0.0;
+        int32 Retries = 0;
+        TUniquePtr<FArchive> Reader;
+    };
+
+    TWeakObjectPtr<UVaroniaMqttClient> Client;
+    int32 ChunkSize;
+    int32 Window;
+    TArray<TUniquePtr<FTransfer>> Queue;
+    TArray<uint8> Chunk;
+    bool bWasConnected = false;
+    int32 NumFailed = 0;
+    FTSTicker::FDelegateHandle TickerHandle;
+    FDelegateHandle MessageHandle;
+
+    bool Tick(float DeltaTime);
+    void HandleMessage(const FString& Topic, const TArray<uint8>& Payload);
+
+    void SendBegin(FTransfer& Transfer);
+    bool SendChunk(FTransfer& Transfer, int32 Index);
+    void Complete(bool bSuccess, const FString& Error = FString());
+};
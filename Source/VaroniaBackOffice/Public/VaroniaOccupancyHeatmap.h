@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LBE_Types.h"
+
+/**
+ * Where players spend time in the play area, binned on a fixed grid over the main boundary's bounds.
+ *
+ * AddSample is lock-free (relaxed atomic increments) and may be called from any thread except while
+ * Init runs, which reallocates the counters: the manager calls both from the game thread. Decay scales
+ * every cell so old sessions fade; an increment racing with it may be lost, which is fine for a
+ * heatmap. Samples within ContactDistance of a boundary edge also count as contact with it.
+ *
+ * Memory is fixed at Init: the cell size grows if the area would need more than MaxCells cells.
+ */
+class VARONIABACKOFFICE_API FVaroniaOccupancyHeatmap
+{
+public:
+    static constexpr int32 MaxCells = 512 * 512;
+    static constexpr uint32 FileMagic = 0x504D4856; // "VHMP"
+
+    /** False if the config has no main boundary. Cell counts survive a re-Init that keeps the same grid,
+     *  contact counts survive for every boundary whose ID is still in the config. */
+    bool Init(const FSpatialConfig& Config, float InCellSize, float InContactDistance);
+    void Reset();
+
+    bool IsValid() const { return Width > 0; }
+
+    void AddSample(const FVector& Location);
+
+    /** Multiply every cell and contact counter by Factor (0..1) */
+    void Decay(float Factor);
+
+    /** Per-boundary contact samples, by boundary ID */
+    TMap<FString, uint32> GetContacts() const;
+
+    /** Grayscale PNG, brightest = busiest cell (square-root scale so quiet areas stay visible),
+     *  oriented like the ortho captures: world -X to the right, +Y up */
+    bool ExportPNG(const FString& Path) const;
+
+    /** "VHMP" | uint16 version | uint16 reserved | int32 width, height | float cell size | float origin X, Y
+     *  | uint32 cells[width * height] (row major, +Y rows) | int32 boundary count | (FString ID, uint32 contacts)... */
+    bool ExportBinary(const FString& Path) const;
+
+    int32 GetWidth() const { return Width; }
+    int32 GetHeight() const { return Height; }
+
+private:
+    struct FContactZone
+    {
+        FString ID;
+        TArray<FVector> Points;
+        FBox2D Bounds;
+    };
+
+    int32 Width = 0;
+    int32 Height = 0;
+    float CellSize = 25.f;
+    float ContactDistance = 30.f;
+    FVector2D Origin = FVector2D::ZeroVector;
+
+    TUniquePtr<std::atomic<uint32>[]> Cells;
+    TUniquePtr<std::atomic<uint32>[]> Contacts;
+    TArray<FContactZone> Zones;
+
+    static void Scale(std::atomic<uint32>& Counter, float Factor);
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LBE_Types.h"
+
+/**
+ * Precomputed Poisson-disk set of positions where something can be placed or spawned: inside the
+ * main boundary, outside every bReverse sub-zone, and at least Clearance away from any boundary edge.
+ *
+ * Validity is evaluated once per build on a fine grid (rows in parallel), then points at least
+ * Spacing apart are grown over it. The result is deterministic for a given config, so every device
+ * gets the same set. Random draws are O(1); nearest queries walk a grid holding at most one point
+ * per cell. Update() only recomputes validity around boundaries that changed, then resamples the
+ * whole area with Build()'s seed, so a patched device and one that built the patched config agree.
+ */
+class VARONIABACKOFFICE_API FVaroniaPlacementPoints
+{
+public:
+    /** False (and empty) without a usable main boundary */
+    bool Build(const FSpatialConfig& Config, float InSpacing, float InClearance);
+
+    /** Recompute validity only inside Dirty (boundaries that moved, old and new extents); full rebuild if the main boundary changed */
+    void Update(const FSpatialConfig& Config, const FBox2D& Dirty);
+
+    const TArray<FVector>& GetPoints() const { return Points; }
+
+    bool GetRandom(FVector& OutPoint) const;
+    bool GetNearest(const FVector& Location, FVector& OutPoint) const;
+
+    /** Extent of every boundary added, removed or reshaped between two configs, for Update() */
+    static FBox2D GetChangedArea(const FSpatialConfig& Old, const FSpatialConfig& New);
+
+private:
+    float Spacing = 100.f;
+    float Clearance = 50.f;
+    float FloorZ = 0.f;
+    FBox2D Bounds = FBox2D(ForceInit);
+    TArray<FVector> MainPoints;
+
+    // Validity field
+    float FieldCell = 10.f;
+    int32 FieldW = 0;
+    int32 FieldH = 0;
+    TArray<uint8> Valid;
+
+    // Points + acceleration grid (cell = Spacing / sqrt 2, so at most one point per cell)
+    TArray<FVector> Points;
+    float GridCell = 70.f;
+    int32 GridW = 0;
+    int32 GridH = 0;
+    TArray<int32> Grid;
+
+    void ComputeValidity(const FSpatialConfig& Config, const FBox2D& Region);
+    bool IsValidAt(const FVector2D& P) const;
+    bool HasNeighbour(const FVector2D& P) const;
+    void AddPoint(const FVector2D& P);
+    void Sample(const FBox2D& Region, uint32 Seed);
+};
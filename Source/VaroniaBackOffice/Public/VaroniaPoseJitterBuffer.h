@@ -0,0 +1,127 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VaroniaPoseJitterBuffer.generated.h"
+
+/** Receive-side statistics of one remote pose stream */
+USTRUCT(BlueprintType)
+struct FVaroniaJitterStats {
+    GENERATED_BODY()
+
+    /** Samples accepted into the buffer */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Poses")
+    int32 Received = 0;
+
+    /** Samples that arrived after their playout time had already passed */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Poses")
+    int32 Late = 0;
+
+    /** Duplicates and samples evicted by ring overflow */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Poses")
+    int32 Dropped = 0;
+
+    /** Frames sampled past the newest sample (short extrapolation) */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Poses")
+    int32 Extrapolated = 0;
+
+    /** Frames where the stream ran dry beyond the extrapolation limit (pose held) */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Poses")
+    int32 Starved = 0;
+
+    /** Current adaptive playout delay */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Poses")
+    float PlayoutDelayMs = 0.f;
+
+    /** Smoothed inter-arrival jitter (RFC 3550 estimator) */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|Poses")
+    float JitterMs = 0.f;
+};
+
+/** Pose message as sent on VaroniaMqttTopics::Pose (40 bytes, little endian) */
+struct VARONIABACKOFFICE_API FVaroniaPoseMessage
+{
+    int32 DeviceID = 0;
+
+    /** Sender clock, seconds */
+    double Timestamp = 0.0;
+
+    FVector Location = FVector::ZeroVector;
+    FQuat Rotation = FQuat::Identity;
+
+    void Encode(TArray<uint8>& OutBytes) const;
+    static bool Decode(const TArray<uint8>& Bytes, FVaroniaPoseMessage& OutMessage);
+};
+
+/** Newest tracker sample of one local device, see UVaroniaBackOfficeManager::SubmitTrackedPose */
+struct FVaroniaTrackedPose
+{
+    FTransform Pose;
+
+    /** Tracker clock, seconds; 0 until the first sample */
+    double Timestamp = 0.0;
+};
+
+/**
+ * Timestamped ring buffer for one remote device.
+ * Samples are played back a small adaptive delay behind the newest arrival so that
+ * irregular MQTT delivery is smoothed out; positions use Hermite interpolation,
+ * rotations slerp, and a short extrapolation covers brief gaps.
+ * Not thread-safe: push and sample from the game thread.
+ */
+class VARONIABACKOFFICE_API FVaroniaPoseJitterBuffer
+{
+public:
+    static constexpr int32 Capacity = 64;
+
+    /** Lower / upper bounds of the adaptive playout delay (seconds) */
+    double MinPlayoutDelay = 0.03;
+    double MaxPlayoutDelay = 0.3;
+
+    /** Playout delay target = JitterMultiplier * jitter + MinPlayoutDelay */
+    double JitterMultiplier = 3.0;
+
+    /** Longest time we extrapolate past the newest sample before holding the pose */
+    double MaxExtrapolation = 0.1;
+
+    /** Add a sample stamped with the sender clock, received at local time LocalTime */
+    void Push(double RemoteTime, double LocalTime, const FVector& Location, const FQuat& Rotation);
+
+    /** Evaluate the pose to display at local time LocalTime. False while the buffer is empty. */
+    bool Sample(double LocalTime, FTransform& OutPose);
+
+    const FVaroniaJitterStats& GetStats() const { return Stats; }
+
+    void Reset();
+
+private:
+    struct FSample
+    {
+        double Time = 0.0;
+        FVector Location = FVector::ZeroVector;
+        FQuat Rotation = FQuat::Identity;
+    };
+
+    FSample Ring[Capacity];
+    int32 Head = 0;
+    int32 Count = 0;
+
+    /** Estimated (local - remote) transit time of the fastest recent packets */
+    double ClockOffset = 0.0;
+    double LastTransit = 0.0;
+    double Jitter = 0.0;
+    double PlayoutDelay = 0.1;
+    bool bHasOffset = false;
+
+    /** Remote time of the last sampled frame; anything older is late */
+    double LastPlayoutTime = -DBL_MAX;
+
+    FVaroniaJitterStats Stats;
+
+    FSample& At(int32 Index) { return Ring[(Head + Index) % Capacity]; }
+    const FSample& At(int32 Index) const { return Ring[(Head + Index) % Capacity]; }
+
+    void InsertAt(int32 Index, const FSample& Sample);
+    void DropFront(int32 Num);
+    FVector TangentAt(int32 Index) const;
+    void UpdateTiming(double RemoteTime, double LocalTime);
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LBE_Types.h"
+#include "VaroniaSoftStateMachine.generated.h"
+
+/** Time spent in one SoftState */
+USTRUCT(BlueprintType)
+struct FVaroniaSoftStateMetrics {
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|SoftState")
+    ESoftState State = ESoftState::UNKNOWN;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|SoftState")
+    int32 EntryCount = 0;
+
+    /** Total seconds spent in the state, including the current visit */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|SoftState")
+    float TotalSeconds = 0.f;
+
+    /** Duration of the last completed visit */
+    UPROPERTY(BlueprintReadOnly, Category = "Varonia|SoftState")
+    float LastSeconds = 0.f;
+};
+
+// ========================
+// Transition table
+// ========================
+
+namespace VaroniaSoftState
+{
+    /** ESoftState values are sparse; everything below works on a dense index */
+    constexpr int32 Num = 8;
+
+    constexpr int32 ToIndex(ESoftState State)
+    {
+        switch (State)
+        {
+        case ESoftState::UNKNOWN:             return 0;
+        case ESoftState::READY:               return 1;
+        case ESoftState::GAME_INLOBBY:        return 2;
+        case ESoftState::GAME_LAUNCHED:       return 3;
+        case ESoftState::GAME_INPARTY:        return 4;
+        case ESoftState::GAME_CHECKING:       return 5;
+        case ESoftState::GAME_SAFETYING:      return 6;
+        case ESoftState::GAME_HOSTCONNECTING: return 7;
+        }
+        return INDEX_NONE;
+    }
+
+    constexpr ESoftState FromIndex(int32 Index)
+    {
+        constexpr ESoftState States[Num] = {
+            ESoftState::UNKNOWN, ESoftState::READY, ESoftState::GAME_INLOBBY, ESoftState::GAME_LAUNCHED,
+            ESoftState::GAME_INPARTY, ESoftState::GAME_CHECKING, ESoftState::GAME_SAFETYING, ESoftState::GAME_HOSTCONNECTING
+        };
+        return States[Index];
+    }
+
+    constexpr uint8 Bit(ESoftState State) { return (uint8)(1u << ToIndex(State)); }
+
+    /** Every state may fall back to UNKNOWN (error) or READY (game left) */
+    constexpr uint8 Always = Bit(ESoftState::UNKNOWN) | Bit(ESoftState::READY);
+
+    /** Row = from state, bits = allowed target states */
+    constexpr uint8 Transitions[Num] = {
+        /* UNKNOWN             */ 0xFF,
+        /* READY               */ Always | Bit(ESoftState::GAME_LAUNCHED),
+        /* GAME_INLOBBY        */ Always | Bit(ESoftState::GAME_CHECKING) | Bit(ESoftState::GAME_INPARTY) | Bit(ESoftState::GAME_HOSTCONNECTING),
+        /* GAME_LAUNCHED       */ Always | Bit(ESoftState::GAME_INLOBBY) | Bit(ESoftState::GAME_HOSTCONNECTING),
+        /* GAME_INPARTY        */ Always | Bit(ESoftState::GAME_INLOBBY) | Bit(ESoftState::GAME_CHECKING) | Bit(ESoftState::GAME_SAFETYING),
+        /* GAME_CHECKING       */ Always | Bit(ESoftState::GAME_SAFETYING) | Bit(ESoftState::GAME_INPARTY) | Bit(ESoftState::GAME_INLOBBY),
+        /* GAME_SAFETYING      */ Always | Bit(ESoftState::GAME_INPARTY) | Bit(ESoftState::GAME_INLOBBY) | Bit(ESoftState::GAME_CHECKING),
+        /* GAME_HOSTCONNECTING */ Always | Bit(ESoftState::GAME_INLOBBY) | Bit(ESoftState::GAME_LAUNCHED),
+    };
+
+    constexpr bool CanTransition(ESoftState From, ESoftState To)
+    {
+        return ToIndex(From) != INDEX_NONE && ToIndex(To) != INDEX_NONE
+            && (Transitions[ToIndex(From)] & Bit(To)) != 0;
+    }
+
+    static_assert(CanTransition(ESoftState::GAME_LAUNCHED, ESoftState::GAME_INLOBBY), "Launch must reach the lobby");
+    static_assert(CanTransition(ESoftState::GAME_INPARTY, ESoftState::READY), "Every state must be able to leave the game");
+    static_assert(!CanTransition(ESoftState::READY, ESoftState::GAME_INPARTY), "Party requires a launched game");
+}
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnVaroniaSoftStateHook, ESoftState /*From*/, ESoftState /*To*/);
+
+/**
+ * Validated SoftState transitions with per-state entry/exit hooks and time-in-state metrics.
+ * Setting the current state again is a no-op (returns false, nothing fires).
+ */
+class VARONIABACKOFFICE_API FVaroniaSoftStateMachine
+{
+public:
+    explicit FVaroniaSoftStateMachine(ESoftState InitialState = ESoftState::UNKNOWN, double Now = 0.0);
+
+    /** Move to NewState if the table allows it; runs exit hooks, then entry hooks */
+    bool TryTransition(ESoftState NewState, double Now);
+
+    ESoftState GetState() const { return State; }
+
+    FOnVaroniaSoftStateHook& OnEnter(ESoftState InState) { return EnterHooks[VaroniaSoftState::ToIndex(InState)]; }
+    FOnVaroniaSoftStateHook& OnExit(ESoftState InState) { return ExitHooks[VaroniaSoftState::ToIndex(InState)]; }
+
+    TArray<FVaroniaSoftStateMetrics> GetMetrics(double Now) const;
+
+    int32 GetRejectedCount() const { return RejectedCount; }
+
+private:
+    ESoftState State;
+    double EnteredAt;
+    int32 RejectedCount = 0;
+
+    FOnVaroniaSoftStateHook EnterHooks[VaroniaSoftState::Num];
+    FOnVaroniaSoftStateHook ExitHooks[VaroniaSoftState::Num];
+
+    int32 EntryCount[VaroniaSoftState::Num] = {};
+    double TotalSeconds[VaroniaSoftState::Num] = {};
+    double LastSeconds[VaroniaSoftState::Num] = {};
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** 2D helpers for boundary polygons (Unreal cm, Z ignored) */
+namespace VaroniaSpatial
+{
+    inline FBox2D GetBounds2D(const TArray<FVector>& Points)
+    {
+        FBox2D Bounds(ForceInit);
+        for (const FVector& Point : Points)
+        {
+            Bounds += FVector2D(Point.X, Point.Y);
+        }
+        return Bounds;
+    }
+
+    /** Even-odd rule; the polygon is implicitly closed */
+    inline bool IsInsidePolygon(const TArray<FVector>& Points, const FVector2D& P)
+    {
+        bool bInside = false;
+        for (int32 i = 0, j = Points.Num() - 1; i < Points.Num(); j = i++)
+        {
+            const FVector& A = Points[i];
+            const FVector& B = Points[j];
+            if ((A.Y > P.Y) != (B.Y > P.Y)
+                && P.X < (B.X - A.X) * (P.Y - A.Y) / (B.Y - A.Y) + A.X)
+            {
+                bInside = !bInside;
+            }
+        }
+        return bInside;
+    }
+
+    /** Squared distance to the closest edge of the closed polygon */
+    inline double DistSquaredToPolygonEdge(const TArray<FVector>& Points, const FVector2D& P)
+    {
+        double Best = TNumericLimits<double>::Max();
+        for (int32 i = 0, j = Points.Num() - 1; i < Points.Num(); j = i++)
+        {
+            const FVector2D A(Points[j].X, Points[j].Y);
+            const FVector2D AB = FVector2D(Points[i].X, Points[i].Y) - A;
+            const double LengthSq = AB.SizeSquared();
+            const double T = LengthSq > UE_SMALL_NUMBER ? FMath::Clamp(FVector2D::DotProduct(P - A, AB) / LengthSq, 0.0, 1.0) : 0.0;
+            Best = FMath::Min(Best, FVector2D::DistSquared(P, A + AB * T));
+        }
+        return Best;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+// In game: "stat Varonia". Nightly soak: -csvCategories=Varonia (or csvprofile start)
+DECLARE_STATS_GROUP(TEXT("Varonia"), STATGROUP_Varonia, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Config Load"), STAT_Varonia_ConfigLoad, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spatial Parse"), STAT_Varonia_SpatialParse, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MQTT Send"), STAT_Varonia_MqttSend, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MQTT Receive"), STAT_Varonia_MqttReceive, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Format Message"), STAT_Varonia_FormatMessage, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse Message"), STAT_Varonia_ParseMessage, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Manager Tick"), STAT_Varonia_ManagerTick, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Scheduler"), STAT_Varonia_Scheduler, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("MQTT Messages Sent"), STAT_Varonia_MessagesSent, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("MQTT Messages Received"), STAT_Varonia_MessagesReceived, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Scheduler Deferred Tasks"), STAT_Varonia_SchedulerDeferred, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Spatial Config"), STAT_Varonia_SpatialMemory, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Pose Buffers"), STAT_Varonia_PoseBufferMemory, STATGROUP_Varonia, VARONIABACKOFFICE_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(VARONIABACKOFFICE_API, Varonia);
+
+/** Cycle counter + CSV timing under the same name; both compile out with stats / CSV disabled */
+#define VARONIA_SCOPE_STAT(StatName) \
+    SCOPE_CYCLE_COUNTER(STAT_Varonia_##StatName); \
+    CSV_SCOPED_TIMING_STAT(Varonia, StatName)
+
+/** Per-frame message counters for both stat and CSV */
+#define VARONIA_COUNT_MESSAGE(StatName) \
+    INC_DWORD_STAT(STAT_Varonia_##StatName); \
+    CSV_CUSTOM_STAT(Varonia, StatName, 1, ECsvCustomStatOp::Accumulate)
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/StructOnScope.h"
+
+/**
+ * Publisher side of struct delta replication.
+ * Keeps a snapshot of the last published value and a per-field dirty mask over the
+ * struct's top-level properties; only dirty fields go out, at most MaxRateHz times per second.
+ *
+ * Delta message (JSON): {"Seq":12,"Full":false,"Fields":{"Battery":0.8}}
+ */
+class VARONIABACKOFFICE_API FVaroniaStructReplicator
+{
+public:
+    FVaroniaStructReplicator(const UScriptStruct* InStruct, float MaxRateHz);
+
+    /** Diff Data against the snapshot, merge changed fields into the dirty mask */
+    void Update(const void* Data);
+
+    /** Mark every field dirty (new subscriber, reconnect, periodic refresh) */
+    void MarkAllDirty();
+
+    /** Build a delta if anything is dirty and the rate cap allows; clears the mask */
+    bool BuildDelta(double Now, FString& OutMessage);
+
+    const UScriptStruct* GetStruct() const { return Struct; }
+
+    /** Force a full message this often even without changes, so late mirrors converge */
+    double FullRefreshInterval = 10.0;
+
+private:
+    const UScriptStruct* Struct;
+    TArray<FProperty*> Fields;
+    FStructOnScope Snapshot;
+    TBitArray<> DirtyMask;
+
+    double MinInterval = 0.1;
+    double LastSendTime = -DBL_MAX;
+    double LastFullTime = -DBL_MAX;
+    uint32 Sequence = 0;
+    bool bFull = true;
+};
+
+/** Receiver side: applies deltas from one remote device into a mirror copy */
+class VARONIABACKOFFICE_API FVaroniaStructMirror
+{
+public:
+    explicit FVaroniaStructMirror(const UScriptStruct* InStruct);
+
+    /** Apply a delta message; stale sequences are ignored unless the message is a full refresh */
+    bool ApplyDelta(const FString& Message);
+
+    const void* GetData() const { return Mirror.GetStructMemory(); }
+    const UScriptStruct* GetStruct() const { return Struct; }
+
+private:
+    const UScriptStruct* Struct;
+    FStructOnScope Mirror;
+    uint32 LastSequence = 0;
+    bool bHasSequence = false;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Unreal Insights channel — enable with -trace=cpu,Varonia
+UE_TRACE_CHANNEL_EXTERN(VaroniaChannel, VARONIABACKOFFICE_API);
+
+/**
+ * Plain-text startup timeline. Scopes are recorded from BeginCollecting() until Finish(),
+ * which prints every span (relative start, duration, thread) to LogVaronia.
+ * Outside that window VARONIA_TRACE_SCOPE only feeds Insights.
+ */
+class VARONIABACKOFFICE_API FVaroniaStartupTrace
+{
+public:
+    static FVaroniaStartupTrace& Get();
+
+    void BeginCollecting();
+
+    /** Dump the summary and stop collecting; no-op if not collecting */
+    void Finish();
+
+    bool IsCollecting() const { return bCollecting; }
+
+    /** Record a span measured elsewhere (async operations such as broker connect) */
+    void AddSpan(const TCHAR* Name, double StartTime, double EndTime);
+
+private:
+    struct FSpan
+    {
+        const TCHAR* Name;
+        double Start;
+        double End;
+        uint32 ThreadId;
+    };
+
+    TArray<FSpan> Spans;
+    FCriticalSection Lock;
+    double Origin = 0.0;
+    std::atomic<bool> bCollecting { false };
+};
+
+/** RAII helper behind VARONIA_TRACE_SCOPE; Name must be a literal */
+struct FVaroniaTraceScope
+{
+    explicit FVaroniaTraceScope(const TCHAR* InName)
+        : Name(InName)
+        , Start(FVaroniaStartupTrace::Get().IsCollecting() ? FPlatformTime::Seconds() : 0.0)
+    {
+    }
+
+    ~FVaroniaTraceScope()
+    {
+        if (Start > 0.0)
+        {
+            FVaroniaStartupTrace::Get().AddSpan(Name, Start, FPlatformTime::Seconds());
+        }
+    }
+
+    const TCHAR* Name;
+    double Start;
+};
+
+#define VARONIA_TRACE_SCOPE(Name) \
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(TEXT(Name), VaroniaChannel); \
+    FVaroniaTraceScope ANONYMOUS_VARIABLE(VaroniaTraceScope_)(TEXT(Name))
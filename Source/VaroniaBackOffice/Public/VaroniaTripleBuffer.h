@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Lock-free single-producer / single-consumer triple buffer: the writer never waits for the
+ * reader and the reader always gets the newest complete value, skipping any in between.
+ *
+ * Three slots rotate between writer, reader and a shared middle. Publishing swaps the written slot
+ * into the middle with a "new" flag; the reader swaps it out only when that flag is set. The only
+ * synchronisation is one atomic exchange per side, and values are never copied by the buffer.
+ */
+template <typename T>
+class TVaroniaTripleBuffer
+{
+public:
+    TVaroniaTripleBuffer() = default;
+    TVaroniaTripleBuffer(const TVaroniaTripleBuffer&) = delete;
+    TVaroniaTripleBuffer& operator=(const TVaroniaTripleBuffer&) = delete;
+
+    // --- Producer thread ---
+
+    /** Slot to fill before Publish; contents are stale (whatever was there two publishes ago) */
+    T& GetWriteBuffer() { return Slots[Write]; }
+
+    void Publish()
+    {
+        Write = Middle.exchange(Write | NewFlag, std::memory_order_acq_rel) & IndexMask;
+    }
+
+    void Publish(const T& Value)
+    {
+        GetWriteBuffer() = Value;
+        Publish();
+    }
+
+    // --- Consumer thread ---
+
+    /** Take the newest published value if there is one; false if Read() is still current */
+    bool Update()
+    {
+        if ((Middle.load(std::memory_order_relaxed) & NewFlag) == 0) return false;
+        Read = Middle.exchange(Read, std::memory_order_acq_rel) & IndexMask;
+        return true;
+    }
+
+    /** Value taken by the last successful Update (default constructed before that) */
+    const T& GetReadBuffer() const { return Slots[Read]; }
+
+    bool HasNewData() const { return (Middle.load(std::memory_order_relaxed) & NewFlag) != 0; }
+
+private:
+    static constexpr uint8 IndexMask = 0x3;
+    static constexpr uint8 NewFlag = 0x4;
+
+    T Slots[3] = {};
+
+    // Each index on its own cache line: writer and reader never share one
+    alignas(PLATFORM_CACHE_LINE_SIZE) uint8 Write = 0;
+    alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint8> Middle { 1 };
+    alignas(PLATFORM_CACHE_LINE_SIZE) uint8 Read = 2;
+};
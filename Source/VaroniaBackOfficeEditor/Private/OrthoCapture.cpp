@@ -3,6 +3,9 @@
 // Place in: Plugins/VaroniaBackOffice/Source/VaroniaBackOfficeEditor/Private/
 
 #include "OrthoCapture.h"
+#include "OrthoCaptureRenderer.h"
+#include "OrthoCaptureSinks.h"
+#include "VaroniaBackOfficeManager.h"
 #include "Containers/Ticker.h"
 #include "Camera/CameraActor.h"
 #include "Camera/CameraComponent.h"
@@ -24,11 +27,11 @@
 #include "Slate/SceneViewport.h"
 #include "ToolMenus.h"
 #include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SCheckBox.h"
 #include "Widgets/Input/SSpinBox.h"
 #include "Widgets/Layout/SBox.h"
 #include "Widgets/Layout/SSpacer.h"
 #include "Widgets/Text/STextBlock.h"
-#include "HighResScreenshot.h"
 
 #define LOCTEXT_NAMESPACE "OrthoCapture"
 
@@ -159,6 +162,43 @@ TSharedRef<SWidget> SOrthoCapture::BuildSetupUI()
 				]
 		]
 
+	+ SVerticalBox::Slot().AutoHeight().Padding(0, 4)
+		[
+			SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center).Padding(0, 0, 8, 0)
+				[
+					SNew(STextBlock).Text(LOCTEXT("Tiles", "Tiles (per side)"))
+				]
+				+ SHorizontalBox::Slot().FillWidth(1.f)
+				[
+					SNew(SSpinBox<int32>)
+						.MinValue(1)
+						.MaxValue(16)
+						.Value(Tiles)
+						.OnValueChanged_Lambda([this](int32 NewValue) { Tiles = NewValue; })
+				]
+		]
+
+	+ SVerticalBox::Slot().AutoHeight().Padding(0, 4)
+		[
+			SNew(SCheckBox)
+				.IsChecked_Lambda([this]() { return bExportPyramid ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+				.OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bExportPyramid = NewState == ECheckBoxState::Checked; })
+				[
+					SNew(STextBlock).Text(LOCTEXT("Pyramid", "Export tile pyramid"))
+				]
+		]
+
+	+ SVerticalBox::Slot().AutoHeight().Padding(0, 4)
+		[
+			SNew(SCheckBox)
+				.IsChecked_Lambda([this]() { return bOverlayBoundaries ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+				.OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bOverlayBoundaries = NewState == ECheckBoxState::Checked; })
+				[
+					SNew(STextBlock).Text(LOCTEXT("Overlay", "Overlay boundaries (NewSpatial.json)"))
+				]
+		]
+
 	+ SVerticalBox::Slot().FillHeight(1.f)
 		[
 			SNew(SSpacer)
@@ -177,7 +217,13 @@ TSharedRef<SWidget> SOrthoCapture::BuildSetupUI()
 				.Content()
 				[
 					SNew(STextBlock)
-						.Text(LOCTEXT("Capture", "CAPTURE & CLOSE (1080p)"))
+						.Text_Lambda([this]()
+							{
+								const FOrthoCaptureSettings Settings = MakeSettings();
+								return FText::Format(LOCTEXT("Capture", "CAPTURE & CLOSE ({0}x{1})"),
+									FText::AsNumber(Settings.Width, &FNumberFormattingOptions::DefaultNoGrouping()),
+									FText::AsNumber(Settings.Height, &FNumberFormattingOptions::DefaultNoGrouping()));
+							})
 						.Font(FCoreStyle::GetDefaultFontStyle("Bold", 12))
 				]
 		]
@@ -220,6 +266,16 @@ void SOrthoCapture::OnAltitudeChanged(float NewValue)
 
 // --------------- Core logic ---------------
 
+FOrthoCaptureSettings SOrthoCapture::MakeSettings() const
+{
+	FOrthoCaptureSettings Settings;
+	Settings.OrthographicSize = OrthographicSize;
+	Settings.CameraHeight = CameraHeight;
+	Settings.Width = 1920 * Tiles;
+	Settings.Height = 1080 * Tiles;
+	return Settings;
+}
+
 void SOrthoCapture::OnStartSetup()
 {
 	bIsSetupMode = true;
@@ -267,12 +323,14 @@ void SOrthoCapture::UpdateCamera()
 		TempCamActor = CamActor;
 	}
 
+	// Preview only: the capture itself renders offscreen with the same framing
+	const FOrthoCaptureSettings Settings = MakeSettings();
 	UCameraComponent* CamComp = CamActor->GetCameraComponent();
 	CamComp->SetProjectionMode(ECameraProjectionMode::Orthographic);
-	CamComp->SetOrthoWidth(OrthographicSize * 355.f);
+	CamComp->SetOrthoWidth(Settings.GetOrthoWidth());
 
-	CamActor->SetActorLocation(FVector(0.f, 0.f, CameraHeight));
-	CamActor->SetActorRotation(FRotator(-90.f, 90.f, 0.f));
+	CamActor->SetActorLocation(Settings.GetCameraLocation());
+	CamActor->SetActorRotation(FOrthoCaptureSettings::GetCameraRotation());
 
 	FLevelEditorViewportClient* ViewportClient = GetActiveLevelViewportClient();
 	if (ViewportClient)
@@ -293,61 +351,69 @@ void SOrthoCapture::UpdateCamera()
 void SOrthoCapture::CaptureAndExit()
 {
 	UWorld* World = GetEditorWorld();
-	if (!World || !TempCamActor.IsValid()) return;
-
-	FLevelEditorViewportClient* ViewportClient = GetActiveLevelViewportClient();
-	if (!ViewportClient || !ViewportClient->Viewport)
-	{
-		Cleanup();
-		return;
-	}
+	if (!World || !TempCamActor.IsValid() || bIsCapturing) return;
 
 	FString MapName = World->GetMapName();
 	MapName.RemoveFromStart(World->StreamingLevelsPrefix);
 	if (MapName.IsEmpty()) MapName = TEXT("UntitledMap");
 
-	FString FileName = FString::Printf(TEXT("%s_%.1f"), *MapName, OrthographicSize);
-	FString FullPath = FPaths::Combine(FPaths::ProjectDir(), FileName);
+	const FString BaseName = FString::Printf(TEXT("%s_%.1f"), *MapName, OrthographicSize);
+	FString FullPath = FPaths::Combine(FPaths::ProjectDir(), BaseName + (Tiles > 1 ? TEXT(".png") : TEXT(".jpg")));
 
-	FHighResScreenshotConfig& ScreenshotConfig = GetHighResScreenshotConfig();
-	ScreenshotConfig.SetResolution(1920, 1080);
-	ScreenshotConfig.SetFilename(FullPath);
-	ScreenshotConfig.bMaskEnabled = false;
+	// The preview camera must not show up in its own capture
+	TempCamActor->SetIsTemporarilyHiddenInEditor(true);
+	bIsCapturing = true;
 
+	UE_LOG(LogOrthoCapture, Log, TEXT("OrthoCapture: capturing -> %s"), *FullPath);
 
-	if (TempCamActor.IsValid())
+	// The window may be closed while the GPU works; only touch it if it is still there
+	TWeakPtr<SOrthoCapture> WeakThis = StaticCastSharedRef<SOrthoCapture>(AsShared());
+	auto OnDone = [WeakThis](bool bSuccess)
 	{
-		TempCamActor->SetIsTemporarilyHiddenInEditor(true);
-	}
+		TSharedPtr<SOrthoCapture> This = WeakThis.Pin();
+		if (!This.IsValid()) return;
+
+		This->bIsCapturing = false;
+		This->Cleanup();
+
+		TSharedPtr<SWindow> ParentWindow = FSlateApplication::Get().FindWidgetWindow(This.ToSharedRef());
+		if (ParentWindow.IsValid())
+		{
+			ParentWindow->RequestDestroyWindow();
+		}
+	};
 
+	const FOrthoCaptureSettings Settings = MakeSettings();
+	TArray<TSharedPtr<IOrthoRowSink>> Sinks;
 
-	// Prend le screenshot MAINTENANT pendant que la caméra ortho est active
-	ViewportClient->Viewport->TakeHighResScreenShot();
+	// Above one tile the image is too large to hold in memory: rows are streamed into the PNG
+	if (Tiles > 1) Sinks.Add(MakeShared<FOrthoStreamingPngWriter>(FullPath));
+	else Sinks.Add(MakeShared<FOrthoImageFileWriter>(FullPath));
 
-	UE_LOG(LogTemp, Log, TEXT("OrthoCapture: Screenshot requested -> %s"), *FullPath);
+	if (bExportPyramid)
+	{
+		Sinks.Add(MakeShared<FOrthoTilePyramidWriter>(FPaths::Combine(FPaths::ProjectDir(), BaseName + TEXT("_tiles")), Settings));
+	}
 
-	// Attendre plusieurs ticks pour que le screenshot soit terminé avant cleanup
-	int32* TickCount = new int32(0);
-	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda(
-		[this, TickCount](float DeltaTime) -> bool
+	FString SpatialJson;
+	FSpatialConfig Spatial;
+	if (bOverlayBoundaries)
+	{
+		if (FFileHelper::LoadFileToString(SpatialJson, *UVaroniaBackOfficeManager::GetSpatialPath())
+			&& UVaroniaBackOfficeManager::ParseSpatialConfig(SpatialJson, Spatial))
 		{
-			(*TickCount)++;
-			if (*TickCount >= 10) // ~10 frames d'attente
-			{
-				delete TickCount;
+			Sinks = { MakeShared<FOrthoBoundaryOverlay>(Settings, Spatial.Boundaries, MoveTemp(Sinks)) };
+		}
+		else
+		{
+			UE_LOG(LogOrthoCapture, Warning, TEXT("OrthoCapture: no readable NewSpatial.json, capturing without the boundary overlay"));
+		}
+	}
 
-				Cleanup();
+	// Lets the back office place the image without manual alignment
+	Sinks.Add(MakeShared<FOrthoSidecarWriter>(FPaths::Combine(FPaths::ProjectDir(), BaseName + TEXT(".json")), Settings, FullPath));
 
-				TSharedPtr<SWindow> ParentWindow = FSlateApplication::Get().FindWidgetWindow(AsShared());
-				if (ParentWindow.IsValid())
-				{
-					ParentWindow->RequestDestroyWindow();
-				}
-				return false; // Stop le ticker
-			}
-			return true; // Continue
-		}
-	));
+	FOrthoCaptureRenderer::CaptureTiled(World, Settings, Tiles, Tiles, MoveTemp(Sinks), OnDone);
 }
 
 void SOrthoCapture::Cleanup()
@@ -0,0 +1,268 @@
+// OrthoCaptureCache.cpp
+
+#include "OrthoCaptureCache.h"
+#include "Components/LightComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Level.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Hash/xxhash.h"
+#include "HAL/FileManager.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/JsonSerializer.h"
+
+// =============================================================================
+// Level hash
+// =============================================================================
+
+namespace
+{
+	struct FLevelHasher
+	{
+		FXxHash64Builder Builder;
+
+		/** Package file contents, hashed once per package (file times do not survive a checkout) */
+		TMap<const UPackage*, FMD5Hash> PackageHashes;
+
+		template <typename T>
+		void Add(const T& Value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Plain data only");
+			Builder.Update(&Value, sizeof(T));
+		}
+
+		void Add(const FString& Value)
+		{
+			Builder.Update(*Value, Value.Len() * sizeof(TCHAR));
+			Add(Value.Len());
+		}
+
+		void Add(const FTransform& Transform)
+		{
+			Add(Transform.GetTranslation());
+			Add(Transform.GetRotation());
+			Add(Transform.GetScale3D());
+		}
+
+		// Edits inside an asset do not change the reference: fold in its package on disk as well
+		void AddAsset(const UObject* Asset)
+		{
+			if (!Asset)
+			{
+				Add(uint8(0));
+				return;
+			}
+
+			Add(Asset->GetPathName());
+			AddPackage(Asset->GetPackage());
+		}
+
+		void AddPackage(const UPackage* Package)
+		{
+			FMD5Hash* Hash = PackageHashes.Find(Package);
+			if (!Hash)
+			{
+				Hash = &PackageHashes.Add(Package);
+				FString Filename;
+				if (FPackageName::DoesPackageExist(Package->GetName(), &Filename))
+				{
+					*Hash = FMD5Hash::HashFile(*Filename);
+				}
+			}
+			Add(Hash->IsValid());
+			if (Hash->IsValid())
+			{
+				Builder.Update(Hash->GetBytes(), Hash->GetSize());
+			}
+		}
+
+		void AddActor(const AActor* Actor)
+		{
+			Add(Actor->GetPathName());
+			Add(Actor->GetClass()->GetPathName());
+			Add(Actor->GetActorTransform());
+			Add(Actor->IsHidden());
+
+			// One file per actor (World Partition): its own package holds the rest of its state
+			if (Actor->IsPackageExternal())
+			{
+				AddPackage(Actor->GetExternalPackage());
+			}
+
+			TInlineComponentArray<UActorComponent*> Components(Actor);
+			for (const UActorComponent* Component : Components)
+			{
+				if (const UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Component))
+				{
+					Add(Primitive->GetClass()->GetPathName());
+					Add(Primitive->GetComponentTransform());
+					Add(Primitive->IsVisible());
+					Add(Primitive->bHiddenInGame);
+
+					if (const UStaticMeshComponent* Mesh = Cast<UStaticMeshComponent>(Primitive))
+					{
+						AddAsset(Mesh->GetStaticMesh());
+					}
+
+					TArray<UMaterialInterface*> Materials;
+					Primitive->GetUsedMaterials(Materials);
+					Add(Materials.Num());
+					for (const UMaterialInterface* Material : Materials)
+					{
+						AddAsset(Material);
+					}
+				}
+				else if (const ULightComponent* Light = Cast<ULightComponent>(Component))
+				{
+					Add(Light->GetClass()->GetPathName());
+					Add(Light->GetComponentTransform());
+					Add(Light->IsVisible());
+					Add(Light->Intensity);
+					Add(Light->LightColor);
+				}
+			}
+		}
+	};
+}
+
+uint64 FOrthoCaptureCache::HashLevel(UWorld* World, const FOrthoCaptureSettings& Settings, const FString& Options)
+{
+	FLevelHasher Hasher;
+	Hasher.Add(Settings.OrthographicSize);
+	Hasher.Add(Settings.CameraHeight);
+	Hasher.Add(Settings.Center);
+	Hasher.Add(Settings.Width);
+	Hasher.Add(Settings.Height);
+	Hasher.Add(Options);
+
+	// Actor order in a level changes on resave without changing the picture
+	for (const ULevel* Level : World->GetLevels())
+	{
+		if (!Level || !Level->bIsVisible) continue;
+
+		TArray<const AActor*> Actors;
+		Actors.Reserve(Level->Actors.Num());
+		for (const AActor* Actor : Level->Actors)
+		{
+			if (Actor && !Actor->IsEditorOnly()) Actors.Add(Actor);
+		}
+		Actors.Sort([](const AActor& A, const AActor& B) { return A.GetFName().LexicalLess(B.GetFName()); });
+
+		// Everything the actor walk does not see (foliage and ISM instances, landscape, BSP, other properties)
+		Hasher.Add(Level->GetPathName());
+		Hasher.AddPackage(Level->GetPackage());
+		for (const AActor* Actor : Actors)
+		{
+			Hasher.AddActor(Actor);
+		}
+	}
+
+	return Hasher.Builder.Finalize().Hash;
+}
+
+// =============================================================================
+// Index
+// =============================================================================
+
+FOrthoCaptureCache::FOrthoCaptureCache(const FString& InDirectory)
+	: IndexPath(InDirectory / TEXT("CaptureCache.json"))
+{
+}
+
+void FOrthoCaptureCache::Load()
+{
+	Entries.Reset();
+
+	FString Json;
+	TSharedPtr<FJsonObject> Root;
+	if (!FFileHelper::LoadFileToString(Json, *IndexPath)
+		|| !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root)
+		|| !Root.IsValid())
+	{
+		return;
+	}
+
+	const TSharedPtr<FJsonObject>* Captures;
+	if (!Root->TryGetObjectField(TEXT("Captures"), Captures)) return;
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*Captures)->Values)
+	{
+		const TSharedPtr<FJsonObject> Object = Pair.Value->AsObject();
+		if (!Object.IsValid()) continue;
+
+		FEntry Entry;
+		FString Hash;
+		if (!Object->TryGetStringField(TEXT("Hash"), Hash)) continue;
+		Entry.Hash = FParse::HexNumber64(*Hash);
+
+		Object->TryGetNumberField(TEXT("OrthographicSize"), Entry.Settings.OrthographicSize);
+		Object->TryGetNumberField(TEXT("CameraHeight"), Entry.Settings.CameraHeight);
+		Object->TryGetNumberField(TEXT("CenterX"), Entry.Settings.Center.X);
+		Object->TryGetNumberField(TEXT("CenterY"), Entry.Settings.Center.Y);
+		Object->TryGetNumberField(TEXT("Width"), Entry.Settings.Width);
+		Object->TryGetNumberField(TEXT("Height"), Entry.Settings.Height);
+		Object->TryGetStringArrayField(TEXT("Outputs"), Entry.Outputs);
+
+		FString Timestamp;
+		if (Object->TryGetStringField(TEXT("Timestamp"), Timestamp)) FDateTime::ParseIso8601(*Timestamp, Entry.Timestamp);
+
+		Entries.Add(Pair.Key, MoveTemp(Entry));
+	}
+}
+
+bool FOrthoCaptureCache::Save() const
+{
+	TSharedRef<FJsonObject> Captures = MakeShared<FJsonObject>();
+	for (const TPair<FString, FEntry>& Pair : Entries)
+	{
+		const FEntry& Entry = Pair.Value;
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetStringField(TEXT("Hash"), FString::Printf(TEXT("%016llx"), Entry.Hash));
+		Object->SetNumberField(TEXT("OrthographicSize"), Entry.Settings.OrthographicSize);
+		Object->SetNumberField(TEXT("CameraHeight"), Entry.Settings.CameraHeight);
+		Object->SetNumberField(TEXT("CenterX"), Entry.Settings.Center.X);
+		Object->SetNumberField(TEXT("CenterY"), Entry.Settings.Center.Y);
+		Object->SetNumberField(TEXT("Width"), Entry.Settings.Width);
+		Object->SetNumberField(TEXT("Height"), Entry.Settings.Height);
+
+		TArray<TSharedPtr<FJsonValue>> Outputs;
+		for (const FString& Output : Entry.Outputs) { Outputs.Add(MakeShared<FJsonValueString>(Output)); }
+		Object->SetArrayField(TEXT("Outputs"), Outputs);
+		Object->SetStringField(TEXT("Timestamp"), Entry.Timestamp.ToIso8601());
+		Captures->SetObjectField(Pair.Key, Object);
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetObjectField(TEXT("Captures"), Captures);
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	return FJsonSerializer::Serialize(Root, Writer) && FFileHelper::SaveStringToFile(Output, *IndexPath);
+}
+
+bool FOrthoCaptureCache::IsUpToDate(const FString& Name, uint64 Hash) const
+{
+	const FEntry* Entry = Entries.Find(Name);
+	if (!Entry || Entry->Hash != Hash || Entry->Outputs.IsEmpty()) return false;
+
+	for (const FString& Output : Entry->Outputs)
+	{
+		if (!IFileManager::Get().FileExists(*Output)) return false;
+	}
+	return true;
+}
+
+void FOrthoCaptureCache::Record(const FString& Name, uint64 Hash, const FOrthoCaptureSettings& Settings, const TArray<FString>& Outputs)
+{
+	FEntry& Entry = Entries.FindOrAdd(Name);
+	Entry.Hash = Hash;
+	Entry.Settings = Settings;
+	Entry.Outputs = Outputs;
+	Entry.Timestamp = FDateTime::UtcNow();
+}
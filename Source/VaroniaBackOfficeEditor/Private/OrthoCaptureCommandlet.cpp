@@ -0,0 +1,504 @@
+// OrthoCaptureCommandlet.cpp
+
+#include "OrthoCaptureCommandlet.h"
+#include "OrthoCaptureSinks.h"
+#include "OrthoFloorPlan.h"
+#include "VaroniaBackOfficeManager.h"
+#include "VaroniaMqttClient.h"
+#include "VaroniaMqttUploader.h"
+#include "VaroniaSpatialMath.h"
+#include "AssetCompilingManager.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "ContentStreaming.h"
+#include "Containers/Ticker.h"
+#include "Dom/JsonObject.h"
+#include "Engine/LevelBounds.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "RenderingThread.h"
+#include "Serialization/JsonSerializer.h"
+#include "ShaderCompiler.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogOrthoCaptureCommandlet, Log, All);
+
+// =============================================================================
+// Main loop pumping
+// =============================================================================
+
+// Commandlets have no engine loop: everything the capture waits on has to be driven by hand
+static void PumpFrame(float DeltaTime)
+{
+	FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+	FTSTicker::GetCoreTicker().Tick(DeltaTime);
+
+	// The next map keeps streaming in while this one renders and encodes
+	ProcessAsyncLoading(true, false, 0.002);
+
+	ENQUEUE_RENDER_COMMAND(OrthoCapturePump)([](FRHICommandListImmediate& RHICmdList)
+	{
+		RHICmdList.ImmediateFlush(EImmediateFlushType::FlushRHIThread);
+	});
+	FlushRenderingCommands();
+
+	FPlatformProcess::Sleep(DeltaTime);
+}
+
+// =============================================================================
+// Commandlet
+// =============================================================================
+
+UOrthoCaptureCommandlet::UOrthoCaptureCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UOrthoCaptureCommandlet::Main(const FString& Params)
+{
+	bCpu = FParse::Param(*Params, TEXT("CPU"));
+	if (!bCpu && !FApp::CanEverRender())
+	{
+		UE_LOG(LogOrthoCaptureCommandlet, Display, TEXT("Rendering is disabled (no -AllowCommandletRendering, or -nullrhi): using the CPU floor plan backend"));
+		bCpu = true;
+	}
+
+	OutputDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Varonia"), TEXT("OrthoCaptures"));
+	FParse::Value(*Params, TEXT("Output="), OutputDir);
+	FParse::Value(*Params, TEXT("Tiles="), Tiles);
+	FParse::Value(*Params, TEXT("Margin="), Margin);
+	FParse::Value(*Params, TEXT("CameraHeight="), CameraHeight);
+	bPyramid = FParse::Param(*Params, TEXT("Pyramid"));
+	bOverlay = FParse::Param(*Params, TEXT("Overlay"));
+	bForce = FParse::Param(*Params, TEXT("Force"));
+	Tiles = FMath::Clamp(Tiles, 1, 16);
+	Margin = FMath::Max(Margin, 1.f);
+	IFileManager::Get().MakeDirectory(*OutputDir, true);
+
+	Cache = MakeUnique<FOrthoCaptureCache>(OutputDir);
+	Cache->Load();
+
+	// Bare map names are looked up in the registry
+	FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get().SearchAllAssets(true);
+
+	TArray<FJob> Jobs;
+	FString MapList;
+	if (FParse::Value(*Params, TEXT("Maps="), MapList, false))
+	{
+		AddMapJobs(MapList, Jobs);
+	}
+	FString SpatialPath;
+	if (FParse::Value(*Params, TEXT("Spatial="), SpatialPath))
+	{
+		AddSpatialJobs(SpatialPath, Jobs);
+	}
+	if (Jobs.IsEmpty())
+	{
+		UE_LOG(LogOrthoCaptureCommandlet, Error, TEXT("Nothing to capture: pass -Maps= and/or -Spatial="));
+		return 1;
+	}
+
+	// Layouts sharing a map are captured on one load
+	Jobs.StableSort([](const FJob& A, const FJob& B) { return A.MapPath < B.MapPath; });
+
+	const double Start = FPlatformTime::Seconds();
+	TArray<FResult> Results;
+	for (int32 First = 0; First < Jobs.Num();)
+	{
+		int32 End = First;
+		while (End < Jobs.Num() && Jobs[End].MapPath == Jobs[First].MapPath) ++End;
+
+		UWorld* World = LoadWorld(Jobs[First].MapPath);
+
+		// Only one world renders at a time; the next one loads in the background meanwhile.
+		// Rooted until LoadWorld picks it up so the collection between maps does not drop it.
+		if (End < Jobs.Num())
+		{
+			LoadPackageAsync(Jobs[End].MapPath, FLoadPackageAsyncDelegate::CreateLambda(
+				[](const FName&, UPackage* Package, EAsyncLoadingResult::Type)
+				{
+					if (Package) Package->AddToRoot();
+				}));
+		}
+
+		for (int32 Index = First; Index < End; ++Index)
+		{
+			if (World)
+			{
+				Results.Add(Capture(World, Jobs[Index]));
+			}
+			else
+			{
+				FResult& Failed = Results.AddDefaulted_GetRef();
+				Failed.Job = Jobs[Index];
+				Failed.Error = TEXT("Map failed to load");
+			}
+		}
+
+		if (World) UnloadWorld(World);
+		First = End;
+	}
+
+	const int32 NumFailed = Results.FilterByPredicate([](const FResult& Result) { return !Result.bSuccess; }).Num();
+	const int32 NumSkipped = Results.FilterByPredicate([](const FResult& Result) { return Result.bSkipped; }).Num();
+	const double Seconds = FPlatformTime::Seconds() - Start;
+	if (!Cache->Save() || !WriteSummary(Results, Seconds))
+	{
+		UE_LOG(LogOrthoCaptureCommandlet, Error, TEXT("Failed to write the summary to %s"), *OutputDir);
+		return 1;
+	}
+
+	UE_LOG(LogOrthoCaptureCommandlet, Display, TEXT("%d captures, %d up to date, %d failed, %.1f s -> %s"), Results.Num(), NumSkipped, NumFailed, Seconds, *OutputDir);
+
+	const int32 NumUploadFailed = Upload(Params, Results);
+	return NumFailed == 0 && NumUploadFailed == 0 ? 0 : 1;
+}
+
+// =============================================================================
+// Jobs
+// =============================================================================
+
+void UOrthoCaptureCommandlet::AddMapJobs(const FString& MapList, TArray<FJob>& OutJobs) const
+{
+	TArray<FString> Maps;
+	MapList.ParseIntoArray(Maps, TEXT("+"));
+	for (const FString& Map : Maps)
+	{
+		FJob Job;
+		Job.MapPath = ResolveMap(Map);
+		if (Job.MapPath.IsEmpty())
+		{
+			UE_LOG(LogOrthoCaptureCommandlet, Error, TEXT("Map %s not found"), *Map);
+			continue;
+		}
+		OutJobs.Add(Job);
+	}
+}
+
+void UOrthoCaptureCommandlet::AddSpatialJobs(const FString& Path, TArray<FJob>& OutJobs) const
+{
+	TArray<FString> Files;
+	if (IFileManager::Get().DirectoryExists(*Path))
+	{
+		IFileManager::Get().FindFiles(Files, *(Path / TEXT("*.json")), true, false);
+		for (FString& File : Files) { File = Path / File; }
+	}
+	else
+	{
+		Files.Add(Path);
+	}
+
+	for (const FString& File : Files)
+	{
+		FString Json;
+		FSpatialConfig Config;
+		if (!FFileHelper::LoadFileToString(Json, *File) || !UVaroniaBackOfficeManager::ParseSpatialConfig(Json, Config) || Config.OrthoKey.IsEmpty())
+		{
+			UE_LOG(LogOrthoCaptureCommandlet, Warning, TEXT("Skipping %s: not a spatial layout with an OrthoKey"), *File);
+			continue;
+		}
+
+		FJob Job;
+		Job.Name = Config.OrthoKey;
+		Job.SpatialPath = File;
+		Job.Boundaries = Config.Boundaries;
+
+		// <Map>_<Size>, as written by the editor tool
+		FString MapName = Config.OrthoKey;
+		int32 Underscore = INDEX_NONE;
+		if (Config.OrthoKey.FindLastChar(TEXT('_'), Underscore) && Config.OrthoKey.Mid(Underscore + 1).IsNumeric())
+		{
+			MapName = Config.OrthoKey.Left(Underscore);
+			Job.OrthographicSize = FCString::Atof(*Config.OrthoKey.Mid(Underscore + 1));
+		}
+		else
+		{
+			for (const FSpatialBoundary& Boundary : Config.Boundaries)
+			{
+				if (Boundary.bMainBoundary) Job.Frame = VaroniaSpatial::GetBounds2D(Boundary.Points);
+			}
+		}
+
+		Job.MapPath = ResolveMap(MapName);
+		if (Job.MapPath.IsEmpty())
+		{
+			UE_LOG(LogOrthoCaptureCommandlet, Error, TEXT("%s: map %s not found"), *File, *MapName);
+			continue;
+		}
+		OutJobs.Add(Job);
+	}
+}
+
+FString UOrthoCaptureCommandlet::ResolveMap(const FString& Map) const
+{
+	if (Map.StartsWith(TEXT("/")))
+	{
+		return FPackageName::DoesPackageExist(Map) ? Map : FString();
+	}
+
+	TArray<FAssetData> Worlds;
+	FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get().GetAssetsByClass(UWorld::StaticClass()->GetClassPathName(), Worlds);
+	for (const FAssetData& Asset : Worlds)
+	{
+		if (Asset.AssetName.ToString() == Map) return Asset.PackageName.ToString();
+	}
+	return FString();
+}
+
+// =============================================================================
+// World lifetime
+// =============================================================================
+
+UWorld* UOrthoCaptureCommandlet::LoadWorld(const FString& MapPath) const
+{
+	UE_LOG(LogOrthoCaptureCommandlet, Display, TEXT("Loading %s"), *MapPath);
+
+	UPackage* Package = LoadPackage(nullptr, *MapPath, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (Package) Package->RemoveFromRoot();
+	if (!World) return nullptr;
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Editor;
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(false)
+			.RequiresHitProxies(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.SetTransactional(false));
+	}
+	GWorld = World;
+	World->UpdateWorldComponents(true, false);
+
+	for (ULevelStreaming* Streaming : World->GetStreamingLevels())
+	{
+		Streaming->SetShouldBeLoaded(true);
+		Streaming->SetShouldBeVisible(true);
+	}
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+
+	// Nothing may still be compiling or streaming when the single-shot render happens
+	FAssetCompilingManager::Get().FinishAllCompilation();
+	if (GShaderCompilingManager) GShaderCompilingManager->FinishAllCompilation();
+	IStreamingManager::Get().StreamAllResources(5.f);
+	FlushRenderingCommands();
+
+	return World;
+}
+
+void UOrthoCaptureCommandlet::UnloadWorld(UWorld* World) const
+{
+	if (GWorld == World) GWorld = nullptr;
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+// =============================================================================
+// Capture
+// =============================================================================
+
+UOrthoCaptureCommandlet::FResult UOrthoCaptureCommandlet::Capture(UWorld* World, const FJob& Job)
+{
+	const double Start = FPlatformTime::Seconds();
+
+	FResult Result;
+	Result.Job = Job;
+
+	FOrthoCaptureSettings& Settings = Result.Settings;
+	Settings.Width = 1920 * Tiles;
+	Settings.Height = 1080 * Tiles;
+	Settings.CameraHeight = CameraHeight;
+
+	if (Job.OrthographicSize > 0.f)
+	{
+		// Same framing as the editor tool, which the back office expects for this OrthoKey
+		Settings.OrthographicSize = Job.OrthographicSize;
+	}
+	else
+	{
+		FBox2D Frame = Job.Frame;
+		if (!Frame.bIsValid)
+		{
+			FBox LevelBox(ForceInit);
+			for (ULevel* Level : World->GetLevels())
+			{
+				if (Level) LevelBox += ALevelBounds::CalculateLevelBounds(Level);
+			}
+			if (LevelBox.IsValid) Frame = FBox2D(FVector2D(LevelBox.Min), FVector2D(LevelBox.Max));
+		}
+		if (!Frame.bIsValid)
+		{
+			Result.Error = TEXT("Nothing to frame");
+			return Result;
+		}
+
+		// Image width runs along world X, height along world Y
+		const FVector2D Size = Frame.GetSize();
+		const double OrthoWidth = FMath::Max(Size.X, Size.Y * Settings.Width / Settings.Height) * Margin;
+		Settings.OrthographicSize = FMath::Max(OrthoWidth / 355.0, 0.1);
+		Settings.Center = Frame.GetCenter();
+	}
+
+	if (Result.Job.Name.IsEmpty())
+	{
+		Result.Job.Name = FString::Printf(TEXT("%s_%.1f"), *FPackageName::GetShortName(Job.MapPath), Settings.OrthographicSize);
+	}
+
+	// Same outputs as the editor tool
+	Result.Output = FPaths::Combine(OutputDir, Result.Job.Name + (Tiles > 1 ? TEXT(".png") : TEXT(".jpg")));
+	const FString PyramidDir = FPaths::Combine(OutputDir, Result.Job.Name + TEXT("_tiles"));
+	const FString SidecarPath = FPaths::Combine(OutputDir, Result.Job.Name + TEXT(".json"));
+	TArray<FString> Outputs = { Result.Output, SidecarPath };
+	if (bPyramid) Outputs.Add(PyramidDir / TEXT("manifest.json"));
+
+	// An overlay also depends on the layout file
+	const bool bDrawBoundaries = bOverlay && !Job.Boundaries.IsEmpty();
+	const FString Options = FString::Printf(TEXT("Tiles=%d Pyramid=%d CPU=%d Overlay=%s"), Tiles, bPyramid, bCpu,
+		bDrawBoundaries ? *LexToString(FMD5Hash::HashFile(*Job.SpatialPath)) : TEXT("0"));
+
+	Result.Hash = FOrthoCaptureCache::HashLevel(World, Settings, Options);
+	if (!bForce && Cache->IsUpToDate(Result.Job.Name, Result.Hash))
+	{
+		Result.bSuccess = true;
+		Result.bSkipped = true;
+		Result.Seconds = FPlatformTime::Seconds() - Start;
+		UE_LOG(LogOrthoCaptureCommandlet, Display, TEXT("%s: up to date (%016llx)"), *Result.Job.Name, Result.Hash);
+		return Result;
+	}
+
+	TArray<TSharedPtr<IOrthoRowSink>> Sinks;
+	if (Tiles > 1) Sinks.Add(MakeShared<FOrthoStreamingPngWriter>(Result.Output));
+	else Sinks.Add(MakeShared<FOrthoImageFileWriter>(Result.Output));
+	if (bPyramid) Sinks.Add(MakeShared<FOrthoTilePyramidWriter>(PyramidDir, Settings));
+	if (bDrawBoundaries) Sinks = { MakeShared<FOrthoBoundaryOverlay>(Settings, Job.Boundaries, MoveTemp(Sinks)) };
+	Sinks.Add(MakeShared<FOrthoSidecarWriter>(SidecarPath, Settings, Result.Output));
+
+	bool bDone = false;
+	auto OnDone = [&Result, &bDone](bool bSuccess)
+	{
+		Result.bSuccess = bSuccess;
+		bDone = true;
+	};
+	if (bCpu) FOrthoFloorPlanRasterizer::Capture(World, Settings, MoveTemp(Sinks), OnDone);
+	else FOrthoCaptureRenderer::CaptureTiled(World, Settings, Tiles, Tiles, MoveTemp(Sinks), OnDone);
+	while (!bDone)
+	{
+		PumpFrame(0.005f);
+	}
+
+	if (Result.bSuccess) Cache->Record(Result.Job.Name, Result.Hash, Settings, Outputs);
+	else Result.Error = TEXT("Capture failed");
+	Result.Seconds = FPlatformTime::Seconds() - Start;
+	UE_LOG(LogOrthoCaptureCommandlet, Display, TEXT("%s: %s (%.1f s)"), *Result.Job.Name, Result.bSuccess ? TEXT("ok") : *Result.Error, Result.Seconds);
+	return Result;
+}
+
+// =============================================================================
+// Summary
+// =============================================================================
+
+bool UOrthoCaptureCommandlet::WriteSummary(const TArray<FResult>& Results, double Seconds) const
+{
+	TArray<TSharedPtr<FJsonValue>> Captures;
+	for (const FResult& Result : Results)
+	{
+		TSharedRef<FJsonObject> Capture = MakeShared<FJsonObject>();
+		Capture->SetStringField(TEXT("Name"), Result.Job.Name);
+		Capture->SetStringField(TEXT("Map"), Result.Job.MapPath);
+		Capture->SetStringField(TEXT("Spatial"), Result.Job.SpatialPath);
+		Capture->SetBoolField(TEXT("Success"), Result.bSuccess);
+		Capture->SetBoolField(TEXT("Skipped"), Result.bSkipped);
+		Capture->SetStringField(TEXT("Hash"), FString::Printf(TEXT("%016llx"), Result.Hash));
+		Capture->SetStringField(TEXT("Error"), Result.Error);
+		Capture->SetNumberField(TEXT("Seconds"), Result.Seconds);
+		Capture->SetStringField(TEXT("Output"), Result.Output);
+		Capture->SetNumberField(TEXT("OrthographicSize"), Result.Settings.OrthographicSize);
+		Capture->SetNumberField(TEXT("CenterX"), Result.Settings.Center.X);
+		Capture->SetNumberField(TEXT("CenterY"), Result.Settings.Center.Y);
+		Capture->SetNumberField(TEXT("Width"), Result.Settings.Width);
+		Capture->SetNumberField(TEXT("Height"), Result.Settings.Height);
+		Capture->SetNumberField(TEXT("CmPerPixel"), Result.Settings.GetCmPerPixel());
+		Captures.Add(MakeShared<FJsonValueObject>(Capture));
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetNumberField(TEXT("Seconds"), Seconds);
+	Root->SetArrayField(TEXT("Captures"), Captures);
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	return FJsonSerializer::Serialize(Root, Writer) && FFileHelper::SaveStringToFile(Output, *FPaths::Combine(OutputDir, TEXT("Summary.json")));
+}
+
+// =============================================================================
+// Upload
+// =============================================================================
+
+int32 UOrthoCaptureCommandlet::Upload(const FString& Params, const TArray<FResult>& Results) const
+{
+	FString Broker;
+	if (!FParse::Value(*Params, TEXT("Upload="), Broker)) return 0;
+
+	FString Host = Broker;
+	int32 Port = 1883;
+	FString PortString;
+	if (Broker.Split(TEXT(":"), &Host, &PortString)) Port = FCString::Atoi(*PortString);
+
+	int32 ClientID = 999;
+	double Timeout = 600.0;
+	FParse::Value(*Params, TEXT("UploadClientID="), ClientID);
+	FParse::Value(*Params, TEXT("UploadTimeout="), Timeout);
+
+	UVaroniaMqttClient* Client = NewObject<UVaroniaMqttClient>();
+	Client->AddToRoot();
+	Client->Connect(Host, Port, ClientID);
+
+	int32 NumFailed = 0;
+	{
+		FVaroniaMqttUploader Uploader(Client);
+		for (const FResult& Result : Results)
+		{
+			if (!Result.bSuccess) continue;
+
+			const FString& Name = Result.Job.Name;
+			bool bQueued = Uploader.Enqueue(Result.Output, FPaths::GetCleanFilename(Result.Output));
+			bQueued &= Uploader.Enqueue(FPaths::Combine(OutputDir, Name + TEXT(".json")), Name + TEXT(".json"));
+			if (bPyramid) bQueued &= Uploader.Enqueue(FPaths::Combine(OutputDir, Name + TEXT("_tiles")), Name + TEXT("_tiles"));
+			if (!bQueued) ++NumFailed;
+		}
+
+		const double Deadline = FPlatformTime::Seconds() + Timeout;
+		while (!Uploader.IsIdle() && FPlatformTime::Seconds() < Deadline)
+		{
+			PumpFrame(0.005f);
+		}
+
+		if (!Uploader.IsIdle())
+		{
+			UE_LOG(LogOrthoCaptureCommandlet, Error, TEXT("Upload to %s timed out after %.0f s"), *Broker, Timeout);
+			++NumFailed;
+		}
+		NumFailed += Uploader.GetNumFailed();
+	}
+
+	Client->Disconnect();
+	Client->RemoveFromRoot();
+
+	UE_LOG(LogOrthoCaptureCommandlet, Display, TEXT("Upload to %s finished, %d failed"), *Broker, NumFailed);
+	return NumFailed;
+}
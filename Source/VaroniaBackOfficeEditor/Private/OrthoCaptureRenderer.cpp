@@ -0,0 +1,285 @@
+// OrthoCaptureRenderer.cpp
+
+#include "OrthoCaptureRenderer.h"
+#include "OrthoCaptureSinks.h"
+#include "Async/Async.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "Containers/Ticker.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/World.h"
+#include "RHIGPUReadback.h"
+#include "RenderingThread.h"
+#include "Tasks/Task.h"
+#include "TextureResource.h"
+#include "UObject/StrongObjectPtr.h"
+
+DEFINE_LOG_CATEGORY(LogOrthoCapture);
+
+// =============================================================================
+// Offscreen capture
+// =============================================================================
+
+namespace
+{
+	struct FPendingCapture
+	{
+		TStrongObjectPtr<USceneCaptureComponent2D> Capture;
+		TStrongObjectPtr<UTextureRenderTarget2D> Target;
+		TUniquePtr<FRHIGPUTextureReadback> Readback;
+		FOrthoCaptureRenderer::FOnPixels OnPixels;
+		TArray<FColor> Pixels;
+		int32 Width = 0;
+		int32 Height = 0;
+		double Deadline = 0.0;
+
+		void Finish(bool bSuccess)
+		{
+			if (Capture.IsValid() && Capture->IsRegistered())
+			{
+				Capture->UnregisterComponent();
+			}
+			Capture.Reset();
+			Target.Reset();
+			OnPixels(bSuccess, MoveTemp(Pixels));
+		}
+	};
+}
+
+void FOrthoCaptureRenderer::CapturePixels(UWorld* World, const FOrthoCaptureSettings& Settings, FOnPixels OnPixels)
+{
+	check(IsInGameThread());
+	if (!World || Settings.Width <= 0 || Settings.Height <= 0)
+	{
+		OnPixels(false, TArray<FColor>());
+		return;
+	}
+
+	TSharedRef<FPendingCapture> State = MakeShared<FPendingCapture>();
+	State->OnPixels = MoveTemp(OnPixels);
+	State->Width = Settings.Width;
+	State->Height = Settings.Height;
+	State->Deadline = FPlatformTime::Seconds() + ReadbackTimeout;
+
+	UTextureRenderTarget2D* Target = NewObject<UTextureRenderTarget2D>(GetTransientPackage());
+	Target->ClearColor = FLinearColor::Black;
+	Target->InitCustomFormat(Settings.Width, Settings.Height, PF_B8G8R8A8, false);
+	Target->UpdateResourceImmediate(true);
+	State->Target.Reset(Target);
+
+	USceneCaptureComponent2D* Capture = NewObject<USceneCaptureComponent2D>(GetTransientPackage());
+	Capture->ProjectionType = ECameraProjectionMode::Orthographic;
+	Capture->OrthoWidth = Settings.GetOrthoWidth();
+	Capture->CaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+	Capture->bCaptureEveryFrame = false;
+	Capture->bCaptureOnMovement = false;
+	Capture->TextureTarget = Target;
+
+	// Single-shot renders: no history to adapt or accumulate from, and tiles must match each other
+	Capture->ShowFlags.SetEyeAdaptation(false);
+	Capture->ShowFlags.SetTemporalAA(false);
+	Capture->ShowFlags.SetMotionBlur(false);
+
+	// Screen-space effects would darken or bleed at every tile border and show as a grid once stitched
+	Capture->ShowFlags.SetVignette(false);
+	Capture->ShowFlags.SetBloom(false);
+	Capture->SetWorldLocationAndRotation(Settings.GetCameraLocation(), FOrthoCaptureSettings::GetCameraRotation());
+	Capture->RegisterComponentWithWorld(World);
+	State->Capture.Reset(Capture);
+
+	Capture->CaptureScene();
+
+	State->Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("OrthoCaptureReadback"));
+	ENQUEUE_RENDER_COMMAND(OrthoCaptureCopy)(
+		[Readback = State->Readback.Get(), Resource = Target->GameThread_GetRenderTargetResource()](FRHICommandListImmediate& RHICmdList)
+		{
+			Readback->EnqueueCopy(RHICmdList, Resource->GetRenderTargetTexture());
+		});
+
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([State](float) -> bool
+	{
+		if (!State->Readback->IsReady())
+		{
+			if (FPlatformTime::Seconds() < State->Deadline) return true;
+
+			UE_LOG(LogOrthoCapture, Error, TEXT("OrthoCapture: GPU readback timed out"));
+			State->Finish(false);
+			return false;
+		}
+
+		// Lock/Unlock belong to the render thread; the copy out is a plain memcpy per row
+		ENQUEUE_RENDER_COMMAND(OrthoCaptureLock)([State](FRHICommandListImmediate&)
+		{
+			int32 RowPitch = 0;
+			const FColor* Data = static_cast<const FColor*>(State->Readback->Lock(RowPitch));
+			const bool bLocked = Data != nullptr;
+			if (bLocked)
+			{
+				State->Pixels.SetNumUninitialized(State->Width * State->Height);
+				for (int32 Y = 0; Y < State->Height; ++Y)
+				{
+					FMemory::Memcpy(&State->Pixels[Y * State->Width], Data + Y * RowPitch, State->Width * sizeof(FColor));
+				}
+				State->Readback->Unlock();
+
+				for (FColor& Pixel : State->Pixels)
+				{
+					Pixel.A = 255;
+				}
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [State, bLocked]() { State->Finish(bLocked); });
+		});
+		return false;
+	}));
+}
+
+// =============================================================================
+// Capture to JPG
+// =============================================================================
+
+void FOrthoCaptureRenderer::CaptureToFile(UWorld* World, const FOrthoCaptureSettings& Settings, const FString& Path, TFunction<void(bool)> OnDone)
+{
+	// A single tile through the tiled path: the file writer encodes on the sink worker
+	CaptureTiled(World, Settings, 1, 1, { MakeShared<FOrthoImageFileWriter>(Path) }, MoveTemp(OnDone));
+}
+
+// =============================================================================
+// Tiled capture
+// =============================================================================
+
+namespace
+{
+	struct FTiledCapture : public TSharedFromThis<FTiledCapture>
+	{
+		TWeakObjectPtr<UWorld> World;
+		FOrthoCaptureSettings Settings;
+		int32 TilesX = 1;
+		int32 TilesY = 1;
+		int32 TileW = 0;
+		int32 TileH = 0;
+		int32 NextTile = 0;
+
+		TArray<TSharedPtr<IOrthoRowSink>> Sinks;
+		TFunction<void(bool)> OnDone;
+
+		TArray<FColor> Band;
+		UE::Tasks::FTask SinkTask;
+
+		/** Sink work of the band before the one in SinkTask */
+		UE::Tasks::FTask PrevSinkTask;
+		std::atomic<bool> bFailed { false };
+
+		void CaptureNext()
+		{
+			if (NextTile == TilesX * TilesY || bFailed)
+			{
+				Complete();
+				return;
+			}
+
+			const int32 X = NextTile % TilesX;
+			const int32 Y = NextTile / TilesX;
+
+			// A new band starts once only one band is left for the sinks: two bands in memory at most
+			if (X == 0 && !PrevSinkTask.IsCompleted())
+			{
+				UE::Tasks::Launch(UE_SOURCE_LOCATION, [This = AsShared()]()
+				{
+					AsyncTask(ENamedThreads::GameThread, [This]() { This->CaptureNext(); });
+				}, PrevSinkTask);
+				return;
+			}
+
+			FOrthoCaptureSettings Tile = Settings;
+			Tile.Width = TileW;
+			Tile.Height = TileH;
+			Tile.OrthographicSize = Settings.OrthographicSize / TilesX;
+			Tile.Center = Settings.PixelToWorld(FVector2D((X + 0.5) * TileW, (Y + 0.5) * TileH));
+
+			FOrthoCaptureRenderer::CapturePixels(World.Get(), Tile, [This = AsShared(), X, Y](bool bSuccess, TArray<FColor>&& Pixels)
+			{
+				This->OnTile(X, Y, bSuccess, Pixels);
+			});
+		}
+
+		void OnTile(int32 X, int32 Y, bool bSuccess, const TArray<FColor>& Pixels)
+		{
+			if (!bSuccess)
+			{
+				bFailed = true;
+				Complete();
+				return;
+			}
+
+			if (Band.Num() == 0)
+			{
+				Band.SetNumUninitialized(Settings.Width * TileH);
+			}
+			for (int32 Row = 0; Row < TileH; ++Row)
+			{
+				FMemory::Memcpy(&Band[Row * Settings.Width + X * TileW], &Pixels[Row * TileW], TileW * sizeof(FColor));
+			}
+
+			if (X == TilesX - 1)
+			{
+				// Chained so bands reach the sinks in order; rendering goes on meanwhile
+				PrevSinkTask = SinkTask;
+				SinkTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [This = AsShared(), Rows = MoveTemp(Band), FirstRow = Y * TileH]()
+				{
+					for (const TSharedPtr<IOrthoRowSink>& Sink : This->Sinks)
+					{
+						if (!This->bFailed && !Sink->AddRows(Rows.GetData(), FirstRow, This->TileH))
+						{
+							This->bFailed = true;
+						}
+					}
+				}, SinkTask);
+				Band.Reset();
+			}
+
+			++NextTile;
+			CaptureNext();
+		}
+
+		void Complete()
+		{
+			UE::Tasks::Launch(UE_SOURCE_LOCATION, [This = AsShared()]()
+			{
+				bool bSuccess = !This->bFailed;
+				for (const TSharedPtr<IOrthoRowSink>& Sink : This->Sinks)
+				{
+					bSuccess &= Sink->Finish();
+				}
+
+				AsyncTask(ENamedThreads::GameThread, [This, bSuccess]() { This->OnDone(bSuccess); });
+			}, SinkTask);
+		}
+	};
+}
+
+void FOrthoCaptureRenderer::CaptureTiled(UWorld* World, const FOrthoCaptureSettings& Settings, int32 TilesX, int32 TilesY,
+	TArray<TSharedPtr<IOrthoRowSink>> Sinks, TFunction<void(bool)> OnDone)
+{
+	check(TilesX > 0 && TilesY > 0 && Settings.Width % TilesX == 0 && Settings.Height % TilesY == 0);
+
+	TSharedRef<FTiledCapture> State = MakeShared<FTiledCapture>();
+	State->World = World;
+	State->Settings = Settings;
+	State->TilesX = TilesX;
+	State->TilesY = TilesY;
+	State->TileW = Settings.Width / TilesX;
+	State->TileH = Settings.Height / TilesY;
+	State->Sinks = MoveTemp(Sinks);
+	State->OnDone = MoveTemp(OnDone);
+
+	for (const TSharedPtr<IOrthoRowSink>& Sink : State->Sinks)
+	{
+		if (!Sink->Begin(Settings.Width, Settings.Height))
+		{
+			State->bFailed = true;
+		}
+	}
+
+	UE_LOG(LogOrthoCapture, Log, TEXT("OrthoCapture: %dx%d in %dx%d tiles"), Settings.Width, Settings.Height, TilesX, TilesY);
+	State->CaptureNext();
+}
@@ -0,0 +1,590 @@
+// OrthoCaptureSinks.cpp
+
+#include "OrthoCaptureSinks.h"
+#include "OrthoCaptureRenderer.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Async/ParallelFor.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/JsonSerializer.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+// =============================================================================
+// FOrthoStreamingPngWriter
+// =============================================================================
+
+struct FOrthoStreamingPngWriter::FDeflateState
+{
+	z_stream Stream;
+};
+
+FOrthoStreamingPngWriter::FOrthoStreamingPngWriter(const FString& InPath)
+	: Path(InPath)
+{
+}
+
+FOrthoStreamingPngWriter::~FOrthoStreamingPngWriter()
+{
+	if (Deflate.IsValid())
+	{
+		deflateEnd(&Deflate->Stream);
+	}
+}
+
+static void WriteBigEndian(uint8* Out, uint32 Value)
+{
+	Out[0] = (uint8)(Value >> 24);
+	Out[1] = (uint8)(Value >> 16);
+	Out[2] = (uint8)(Value >> 8);
+	Out[3] = (uint8)Value;
+}
+
+void FOrthoStreamingPngWriter::WriteChunk(const char* Type, const uint8* Data, int32 Size)
+{
+	uint8 Header[8];
+	WriteBigEndian(Header, (uint32)Size);
+	FMemory::Memcpy(Header + 4, Type, 4);
+
+	uint32 Crc = crc32(0, reinterpret_cast<const Bytef*>(Type), 4);
+	Crc = crc32(Crc, Data, Size);
+	uint8 Footer[4];
+	WriteBigEndian(Footer, Crc);
+
+	File->Serialize(Header, sizeof(Header));
+	File->Serialize(const_cast<uint8*>(Data), Size);
+	File->Serialize(Footer, sizeof(Footer));
+}
+
+bool FOrthoStreamingPngWriter::Begin(int32 InWidth, int32 InHeight)
+{
+	Width = InWidth;
+	Height = InHeight;
+
+	File.Reset(IFileManager::Get().CreateFileWriter(*Path));
+	if (!File.IsValid())
+	{
+		UE_LOG(LogOrthoCapture, Error, TEXT("OrthoCapture: cannot write %s"), *Path);
+		return false;
+	}
+
+	Deflate = MakeUnique<FDeflateState>();
+	FMemory::Memzero(Deflate->Stream);
+	if (deflateInit(&Deflate->Stream, 6) != Z_OK)
+	{
+		Deflate.Reset();
+		return false;
+	}
+
+	static const uint8 Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	File->Serialize(const_cast<uint8*>(Signature), sizeof(Signature));
+
+	// 8-bit RGB, deflate, adaptive filtering, no interlace
+	uint8 Header[13];
+	WriteBigEndian(Header, (uint32)Width);
+	WriteBigEndian(Header + 4, (uint32)Height);
+	Header[8] = 8;
+	Header[9] = 2;
+	Header[10] = Header[11] = Header[12] = 0;
+	WriteChunk("IHDR", Header, sizeof(Header));
+
+	Row.SetNumUninitialized(1 + Width * 3);
+	Chunk.SetNumUninitialized(ChunkSize);
+	Deflate->Stream.next_out = Chunk.GetData();
+	Deflate->Stream.avail_out = ChunkSize;
+	return true;
+}
+
+bool FOrthoStreamingPngWriter::Compress(const uint8* Data, int32 Size, bool bFinish)
+{
+	z_stream& Stream = Deflate->Stream;
+	Stream.next_in = const_cast<Bytef*>(Data);
+	Stream.avail_in = Size;
+
+	for (;;)
+	{
+		const int32 Result = deflate(&Stream, bFinish ? Z_FINISH : Z_NO_FLUSH);
+		if (Result == Z_STREAM_ERROR) return false;
+
+		if (Stream.avail_out == 0 || (bFinish && Result == Z_STREAM_END))
+		{
+			WriteChunk("IDAT", Chunk.GetData(), ChunkSize - Stream.avail_out);
+			Stream.next_out = Chunk.GetData();
+			Stream.avail_out = ChunkSize;
+		}
+
+		if (bFinish ? Result == Z_STREAM_END : Stream.avail_in == 0) return true;
+	}
+}
+
+bool FOrthoStreamingPngWriter::AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows)
+{
+	if (!Deflate.IsValid()) return false;
+
+	for (int32 Y = 0; Y < NumRows; ++Y)
+	{
+		// Filter type 1 (Sub): each byte minus the same channel of the pixel to its left
+		const FColor* Pixels = Rows + Y * Width;
+		uint8* Out = Row.GetData();
+		*Out++ = 1;
+		FColor Left(0, 0, 0);
+		for (int32 X = 0; X < Width; ++X)
+		{
+			const FColor& Pixel = Pixels[X];
+			*Out++ = Pixel.R - Left.R;
+			*Out++ = Pixel.G - Left.G;
+			*Out++ = Pixel.B - Left.B;
+			Left = Pixel;
+		}
+
+		if (!Compress(Row.GetData(), Row.Num(), false)) return false;
+	}
+	return true;
+}
+
+bool FOrthoStreamingPngWriter::Finish()
+{
+	if (!Deflate.IsValid()) return false;
+
+	const bool bCompressed = Compress(nullptr, 0, true);
+	deflateEnd(&Deflate->Stream);
+	Deflate.Reset();
+
+	WriteChunk("IEND", nullptr, 0);
+	const bool bWritten = bCompressed && File->Close() && !File->IsError();
+	File.Reset();
+	return bWritten;
+}
+
+// =============================================================================
+// FOrthoImageFileWriter
+// =============================================================================
+
+FOrthoImageFileWriter::FOrthoImageFileWriter(const FString& InPath)
+	: Path(InPath)
+{
+}
+
+bool FOrthoImageFileWriter::Begin(int32 InWidth, int32 InHeight)
+{
+	// Begin runs on the game thread, the only place modules may be loaded
+	ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+	Width = InWidth;
+	Height = InHeight;
+	Pixels.SetNumUninitialized(Width * Height);
+	return true;
+}
+
+bool FOrthoImageFileWriter::AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows)
+{
+	FMemory::Memcpy(&Pixels[FirstRow * Width], Rows, NumRows * Width * sizeof(FColor));
+	return true;
+}
+
+bool FOrthoImageFileWriter::Finish()
+{
+	const bool bPng = Path.EndsWith(TEXT(".png"));
+	TSharedPtr<IImageWrapper> Image = ImageWrapperModule->CreateImageWrapper(bPng ? EImageFormat::PNG : EImageFormat::JPEG);
+	const bool bSaved = Image.IsValid()
+		&& Image->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), Width, Height, ERGBFormat::BGRA, 8)
+		&& FFileHelper::SaveArrayToFile(Image->GetCompressed(bPng ? 0 : 90), *Path);
+
+	Pixels.Empty();
+	UE_LOG(LogOrthoCapture, Log, TEXT("OrthoCapture: %s %s"), bSaved ? TEXT("saved") : TEXT("failed to save"), *Path);
+	return bSaved;
+}
+
+// =============================================================================
+// FOrthoTilePyramidWriter
+// =============================================================================
+
+FOrthoTilePyramidWriter::FOrthoTilePyramidWriter(const FString& InDirectory, const FOrthoCaptureSettings& InSettings, int32 InTileSize, int32 InQuality)
+	: Directory(InDirectory)
+	, Settings(InSettings)
+	, TileSize(InTileSize)
+	, Quality(InQuality)
+	, MaxEncodesInFlight(FMath::Max(2 * FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 4))
+{
+}
+
+bool FOrthoTilePyramidWriter::Begin(int32 InWidth, int32 InHeight)
+{
+	ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+	Levels.Reset();
+	int32 Width = InWidth;
+	int32 Height = InHeight;
+	for (;;)
+	{
+		FLevel& Level = Levels.AddDefaulted_GetRef();
+		Level.Width = Width;
+		Level.Height = Height;
+		Level.Band.SetNumUninitialized(Width * TileSize);
+		Level.PendingRow.SetNumUninitialized(Width);
+
+		if (Width <= TileSize && Height <= TileSize) break;
+		Width = FMath::Max((Width + 1) / 2, 1);
+		Height = FMath::Max((Height + 1) / 2, 1);
+	}
+
+	return IFileManager::Get().MakeDirectory(*Directory, true);
+}
+
+bool FOrthoTilePyramidWriter::AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows)
+{
+	for (int32 Y = 0; Y < NumRows; ++Y)
+	{
+		AddRow(0, Rows + Y * Levels[0].Width);
+	}
+	return !bFailed;
+}
+
+void FOrthoTilePyramidWriter::AddRow(int32 LevelIndex, const FColor* Row)
+{
+	FLevel& Level = Levels[LevelIndex];
+	FMemory::Memcpy(&Level.Band[Level.BandRows * Level.Width], Row, Level.Width * sizeof(FColor));
+	if (++Level.BandRows == TileSize)
+	{
+		FlushBand(LevelIndex);
+	}
+
+	if (LevelIndex + 1 == Levels.Num()) return;
+
+	if (!Level.bHasPendingRow)
+	{
+		FMemory::Memcpy(Level.PendingRow.GetData(), Row, Level.Width * sizeof(FColor));
+		Level.bHasPendingRow = true;
+		return;
+	}
+
+	Level.bHasPendingRow = false;
+	Downsample(LevelIndex, Level.PendingRow.GetData(), Row);
+}
+
+void FOrthoTilePyramidWriter::Downsample(int32 LevelIndex, const FColor* RowA, const FColor* RowB)
+{
+	// 2x2 box filter; an odd last column is averaged with itself
+	const int32 Width = Levels[LevelIndex].Width;
+	TArray<FColor> Half;
+	Half.SetNumUninitialized(Levels[LevelIndex + 1].Width);
+	for (int32 X = 0; X < Half.Num(); ++X)
+	{
+		const int32 X0 = 2 * X;
+		const int32 X1 = FMath::Min(X0 + 1, Width - 1);
+		const FColor& A = RowA[X0];
+		const FColor& B = RowA[X1];
+		const FColor& C = RowB[X0];
+		const FColor& D = RowB[X1];
+		Half[X] = FColor(
+			(uint8)((A.R + B.R + C.R + D.R + 2) / 4),
+			(uint8)((A.G + B.G + C.G + D.G + 2) / 4),
+			(uint8)((A.B + B.B + C.B + D.B + 2) / 4),
+			255);
+	}
+	AddRow(LevelIndex + 1, Half.GetData());
+}
+
+void FOrthoTilePyramidWriter::FlushBand(int32 LevelIndex)
+{
+	FLevel& Level = Levels[LevelIndex];
+	if (Level.BandRows == 0) return;
+
+	const int32 TileRow = Level.BandFirstRow / TileSize;
+	for (int32 Column = 0; Column * TileSize < Level.Width; ++Column)
+	{
+		const int32 TileW = FMath::Min(TileSize, Level.Width - Column * TileSize);
+		const int32 TileH = Level.BandRows;
+
+		TArray<FColor> Tile;
+		Tile.SetNumUninitialized(TileW * TileH);
+		for (int32 Y = 0; Y < TileH; ++Y)
+		{
+			FMemory::Memcpy(&Tile[Y * TileW], &Level.Band[Y * Level.Width + Column * TileSize], TileW * sizeof(FColor));
+		}
+
+		// The capture must not outrun the encoders: wait for the oldest tile beyond the cap
+		Encodes.RemoveAll([](const UE::Tasks::FTask& Encode) { return Encode.IsCompleted(); });
+		while (Encodes.Num() >= MaxEncodesInFlight)
+		{
+			Encodes[0].Wait();
+			Encodes.RemoveAt(0);
+		}
+
+		const FString Path = Directory / FString::Printf(TEXT("%d/%d_%d.jpg"), LevelIndex, Column, TileRow);
+		Encodes.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Path, Tile = MoveTemp(Tile), TileW, TileH]()
+		{
+			TSharedPtr<IImageWrapper> Jpg = ImageWrapperModule->CreateImageWrapper(EImageFormat::JPEG);
+			if (!Jpg.IsValid()
+				|| !Jpg->SetRaw(Tile.GetData(), Tile.Num() * sizeof(FColor), TileW, TileH, ERGBFormat::BGRA, 8)
+				|| !FFileHelper::SaveArrayToFile(Jpg->GetCompressed(Quality), *Path))
+			{
+				bFailed = true;
+			}
+		}));
+	}
+
+	Level.BandFirstRow += Level.BandRows;
+	Level.BandRows = 0;
+}
+
+bool FOrthoTilePyramidWriter::Finish()
+{
+	// Odd heights leave a row waiting for a partner: pair it with itself, one level down only
+	// (the row itself is already in this level's band)
+	for (int32 LevelIndex = 0; LevelIndex + 1 < Levels.Num(); ++LevelIndex)
+	{
+		FLevel& Level = Levels[LevelIndex];
+		if (Level.bHasPendingRow)
+		{
+			Level.bHasPendingRow = false;
+			Downsample(LevelIndex, Level.PendingRow.GetData(), Level.PendingRow.GetData());
+		}
+	}
+	for (int32 LevelIndex = 0; LevelIndex < Levels.Num(); ++LevelIndex)
+	{
+		FlushBand(LevelIndex);
+	}
+
+	UE::Tasks::Wait(Encodes);
+	Encodes.Reset();
+	Levels.Reset();
+
+	return !bFailed && WriteManifest();
+}
+
+bool FOrthoTilePyramidWriter::WriteManifest() const
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("TileSize"), TileSize);
+	Root->SetStringField(TEXT("Format"), TEXT("jpg"));
+	Root->SetNumberField(TEXT("Width"), Settings.Width);
+	Root->SetNumberField(TEXT("Height"), Settings.Height);
+
+	// Full-resolution pixel -> world: X = CenterX - (px - W/2) * CmPerPixel, Y = CenterY - (py - H/2) * CmPerPixel
+	Root->SetNumberField(TEXT("CmPerPixel"), Settings.GetCmPerPixel());
+	Root->SetNumberField(TEXT("CenterX"), Settings.Center.X);
+	Root->SetNumberField(TEXT("CenterY"), Settings.Center.Y);
+
+	TArray<TSharedPtr<FJsonValue>> LevelValues;
+	int32 Width = Settings.Width;
+	int32 Height = Settings.Height;
+	double Scale = Settings.GetCmPerPixel();
+	for (int32 LevelIndex = 0; ; ++LevelIndex)
+	{
+		TSharedRef<FJsonObject> Level = MakeShared<FJsonObject>();
+		Level->SetNumberField(TEXT("Level"), LevelIndex);
+		Level->SetNumberField(TEXT("Width"), Width);
+		Level->SetNumberField(TEXT("Height"), Height);
+		Level->SetNumberField(TEXT("Columns"), FMath::DivideAndRoundUp(Width, TileSize));
+		Level->SetNumberField(TEXT("Rows"), FMath::DivideAndRoundUp(Height, TileSize));
+		Level->SetNumberField(TEXT("CmPerPixel"), Scale);
+		LevelValues.Add(MakeShared<FJsonValueObject>(Level));
+
+		if (Width <= TileSize && Height <= TileSize) break;
+		Width = FMath::Max((Width + 1) / 2, 1);
+		Height = FMath::Max((Height + 1) / 2, 1);
+		Scale *= 2.0;
+	}
+	Root->SetNumberField(TEXT("LevelCount"), LevelValues.Num());
+	Root->SetArrayField(TEXT("Levels"), LevelValues);
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	return FJsonSerializer::Serialize(Root, Writer) && FFileHelper::SaveStringToFile(Output, *(Directory / TEXT("manifest.json")));
+}
+
+// =============================================================================
+// FOrthoSidecarWriter
+// =============================================================================
+
+FOrthoSidecarWriter::FOrthoSidecarWriter(const FString& InPath, const FOrthoCaptureSettings& InSettings, const FString& InImage)
+	: Path(InPath)
+	, Settings(InSettings)
+	, Image(InImage)
+{
+}
+
+static TArray<TSharedPtr<FJsonValue>> MakeAffine(double A, double B, double C, double D, double E, double F)
+{
+	TArray<TSharedPtr<FJsonValue>> Values;
+	for (double Value : { A, B, C, D, E, F }) { Values.Add(MakeShared<FJsonValueNumber>(Value)); }
+	return Values;
+}
+
+bool FOrthoSidecarWriter::Finish()
+{
+	const double S = Settings.GetCmPerPixel();
+	const double W = Settings.Width;
+	const double H = Settings.Height;
+	const FVector Camera = Settings.GetCameraLocation();
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("Image"), FPaths::GetCleanFilename(Image));
+	Root->SetNumberField(TEXT("Width"), Settings.Width);
+	Root->SetNumberField(TEXT("Height"), Settings.Height);
+	Root->SetNumberField(TEXT("OrthographicSize"), Settings.OrthographicSize);
+	Root->SetNumberField(TEXT("OrthoWidth"), Settings.GetOrthoWidth());
+	Root->SetNumberField(TEXT("CmPerPixel"), S);
+
+	TSharedRef<FJsonObject> CameraObject = MakeShared<FJsonObject>();
+	CameraObject->SetNumberField(TEXT("x"), Camera.X);
+	CameraObject->SetNumberField(TEXT("y"), Camera.Y);
+	CameraObject->SetNumberField(TEXT("z"), Camera.Z);
+	Root->SetObjectField(TEXT("CameraLocation"), CameraObject);
+
+	// [a, b, c, d, e, f]: u = a*x + b*y + c, v = d*x + e*y + f. Pixels are (x right, y down) with
+	// pixel centres at .5; Unreal is (X, Y) in cm; Unity is NewSpatial.json (x, z) in metres.
+	Root->SetStringField(TEXT("AffineLayout"), TEXT("u = a*x + b*y + c, v = d*x + e*y + f"));
+	Root->SetArrayField(TEXT("PixelToUnreal"), MakeAffine(-S, 0.0, Settings.Center.X + W * 0.5 * S, 0.0, -S, Settings.Center.Y + H * 0.5 * S));
+	Root->SetArrayField(TEXT("UnrealToPixel"), MakeAffine(-1.0 / S, 0.0, Settings.Center.X / S + W * 0.5, 0.0, -1.0 / S, Settings.Center.Y / S + H * 0.5));
+
+	// Unity x -> Unreal Y and Unity z -> Unreal X, metres to cm
+	Root->SetArrayField(TEXT("PixelToUnity"), MakeAffine(0.0, -S / 100.0, (Settings.Center.Y + H * 0.5 * S) / 100.0, -S / 100.0, 0.0, (Settings.Center.X + W * 0.5 * S) / 100.0));
+	Root->SetArrayField(TEXT("UnityToPixel"), MakeAffine(0.0, -100.0 / S, Settings.Center.X / S + W * 0.5, -100.0 / S, 0.0, Settings.Center.Y / S + H * 0.5));
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	return FJsonSerializer::Serialize(Root, Writer) && FFileHelper::SaveStringToFile(Output, *Path);
+}
+
+// =============================================================================
+// FOrthoBoundaryOverlay
+// =============================================================================
+
+FOrthoBoundaryOverlay::FOrthoBoundaryOverlay(const FOrthoCaptureSettings& InSettings, const TArray<FSpatialBoundary>& Boundaries,
+	TArray<TSharedPtr<IOrthoRowSink>> InInner, float InLineWidth)
+	: Settings(InSettings)
+	, Source(Boundaries)
+	, Inner(MoveTemp(InInner))
+	, LineWidth(InLineWidth)
+{
+}
+
+bool FOrthoBoundaryOverlay::Begin(int32 InWidth, int32 InHeight)
+{
+	Width = InWidth;
+
+	// Segments in pixel space, padded in Y by the reach of the anti-aliased edge
+	const float Reach = LineWidth * 0.5f + 1.f;
+	Polylines.Reset();
+	for (const FSpatialBoundary& Boundary : Source)
+	{
+		if (!Boundary.bVisible || Boundary.Points.Num() < 2) continue;
+
+		FPolyline& Polyline = Polylines.AddDefaulted_GetRef();
+		Polyline.Color = Boundary.BoundaryColor.ToFColor(true);
+		for (int32 i = 0, j = Boundary.Points.Num() - 1; i < Boundary.Points.Num(); j = i++)
+		{
+			FSegment Segment;
+			Segment.A = Settings.WorldToPixel(FVector2D(Boundary.Points[j]));
+			Segment.B = Settings.WorldToPixel(FVector2D(Boundary.Points[i]));
+			Segment.MinY = FMath::Min(Segment.A.Y, Segment.B.Y) - Reach;
+			Segment.MaxY = FMath::Max(Segment.A.Y, Segment.B.Y) + Reach;
+			Polyline.Segments.Add(Segment);
+		}
+	}
+	Source.Empty();
+
+	bool bOk = true;
+	for (const TSharedPtr<IOrthoRowSink>& Sink : Inner) { bOk &= Sink->Begin(InWidth, InHeight); }
+	return bOk;
+}
+
+bool FOrthoBoundaryOverlay::AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows)
+{
+	Band.SetNumUninitialized(Width * NumRows);
+	FMemory::Memcpy(Band.GetData(), Rows, Band.Num() * sizeof(FColor));
+
+	const int32 NumStrips = FMath::DivideAndRoundUp(NumRows, StripRows);
+	ParallelFor(NumStrips, [this, FirstRow, NumRows](int32 Strip)
+	{
+		const int32 Offset = Strip * StripRows;
+		DrawStrip(&Band[Offset * Width], FirstRow + Offset, FMath::Min(StripRows, NumRows - Offset));
+	});
+
+	bool bOk = true;
+	for (const TSharedPtr<IOrthoRowSink>& Sink : Inner) { bOk &= Sink->AddRows(Band.GetData(), FirstRow, NumRows); }
+	return bOk;
+}
+
+void FOrthoBoundaryOverlay::DrawStrip(FColor* Rows, int32 FirstRow, int32 NumRows) const
+{
+	const float HalfWidth = LineWidth * 0.5f;
+	const float Reach = HalfWidth + 1.f;
+	TArray<float> Coverage;
+
+	for (const FPolyline& Polyline : Polylines)
+	{
+		// Column span touched in this strip, and the strongest coverage per pixel over all segments
+		int32 MinX = Width;
+		int32 MaxX = -1;
+		for (const FSegment& Segment : Polyline.Segments)
+		{
+			if (Segment.MaxY < FirstRow || Segment.MinY > FirstRow + NumRows) continue;
+			MinX = FMath::Min(MinX, FMath::Max(0, FMath::FloorToInt(FMath::Min(Segment.A.X, Segment.B.X) - Reach)));
+			MaxX = FMath::Max(MaxX, FMath::Min(Width - 1, FMath::CeilToInt(FMath::Max(Segment.A.X, Segment.B.X) + Reach)));
+		}
+		if (MaxX < MinX) continue;
+
+		const int32 SpanW = MaxX - MinX + 1;
+		Coverage.SetNumUninitialized(SpanW * NumRows);
+		FMemory::Memzero(Coverage.GetData(), Coverage.Num() * sizeof(float));
+
+		for (const FSegment& Segment : Polyline.Segments)
+		{
+			if (Segment.MaxY < FirstRow || Segment.MinY > FirstRow + NumRows) continue;
+
+			const int32 X0 = FMath::Max(MinX, FMath::FloorToInt(FMath::Min(Segment.A.X, Segment.B.X) - Reach));
+			const int32 X1 = FMath::Min(MaxX, FMath::CeilToInt(FMath::Max(Segment.A.X, Segment.B.X) + Reach));
+			const int32 Y0 = FMath::Max(FirstRow, FMath::FloorToInt(Segment.MinY));
+			const int32 Y1 = FMath::Min(FirstRow + NumRows - 1, FMath::CeilToInt(Segment.MaxY));
+
+			const FVector2D AB = Segment.B - Segment.A;
+			const double InvLengthSq = AB.SizeSquared() > UE_SMALL_NUMBER ? 1.0 / AB.SizeSquared() : 0.0;
+			for (int32 Y = Y0; Y <= Y1; ++Y)
+			{
+				float* CoverageRow = Coverage.GetData() + (Y - FirstRow) * SpanW - MinX;
+				for (int32 X = X0; X <= X1; ++X)
+				{
+					const FVector2D P(X + 0.5, Y + 0.5);
+					const double T = FMath::Clamp(FVector2D::DotProduct(P - Segment.A, AB) * InvLengthSq, 0.0, 1.0);
+					const float Distance = (float)FVector2D::Distance(P, Segment.A + AB * T);
+
+					// One pixel of linear falloff around the stroke
+					const float Alpha = FMath::Clamp(HalfWidth + 0.5f - Distance, 0.f, 1.f);
+					CoverageRow[X] = FMath::Max(CoverageRow[X], Alpha);
+				}
+			}
+		}
+
+		for (int32 Y = 0; Y < NumRows; ++Y)
+		{
+			const float* CoverageRow = &Coverage[Y * SpanW];
+			FColor* Row = Rows + Y * Width + MinX;
+			for (int32 X = 0; X < SpanW; ++X)
+			{
+				const float Alpha = CoverageRow[X];
+				if (Alpha <= 0.f) continue;
+
+				FColor& Pixel = Row[X];
+				Pixel.R = (uint8)FMath::RoundToInt(FMath::Lerp((float)Pixel.R, (float)Polyline.Color.R, Alpha));
+				Pixel.G = (uint8)FMath::RoundToInt(FMath::Lerp((float)Pixel.G, (float)Polyline.Color.G, Alpha));
+				Pixel.B = (uint8)FMath::RoundToInt(FMath::Lerp((float)Pixel.B, (float)Polyline.Color.B, Alpha));
+			}
+		}
+	}
+}
+
+bool FOrthoBoundaryOverlay::Finish()
+{
+	Band.Empty();
+	bool bOk = true;
+	for (const TSharedPtr<IOrthoRowSink>& Sink : Inner) { bOk &= Sink->Finish(); }
+	return bOk;
+}
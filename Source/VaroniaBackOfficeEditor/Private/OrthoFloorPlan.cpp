@@ -0,0 +1,336 @@
+// OrthoFloorPlan.cpp
+
+#include "OrthoFloorPlan.h"
+#include "OrthoCaptureSinks.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Level.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "MeshDescription.h"
+#include "StaticMeshAttributes.h"
+#include "Tasks/Task.h"
+
+// =============================================================================
+// Geometry
+// =============================================================================
+
+namespace
+{
+	/** Triangle in pixel space (x right, y down) with world heights */
+	struct FPixelTriangle
+	{
+		FVector2f P0, P1, P2;
+		float Z0, Z1, Z2;
+
+		/** |normal.Z|: 1 for floors, 0 for walls */
+		float Flatness;
+	};
+
+	struct FMeshInstance
+	{
+		int32 Mesh;
+		FTransform Transform;
+	};
+
+	/** Local-space triangle corners, three per triangle */
+	TArray<FVector3f> ExtractTriangles(const FMeshDescription& Description)
+	{
+		FStaticMeshConstAttributes Attributes(Description);
+		TVertexAttributesConstRef<FVector3f> Positions = Attributes.GetVertexPositions();
+
+		TArray<FVector3f> Corners;
+		Corners.Reserve(Description.Triangles().Num() * 3);
+		for (const FTriangleID Triangle : Description.Triangles().GetElementIDs())
+		{
+			for (const FVertexID Vertex : Description.GetTriangleVertices(Triangle))
+			{
+				Corners.Add(Positions[Vertex]);
+			}
+		}
+		return Corners;
+	}
+
+	void ProjectInstance(const FOrthoCaptureSettings& Settings, const TArray<FVector3f>& Corners, const FTransform& Transform, TArray<FPixelTriangle>& Out)
+	{
+		for (int32 i = 0; i + 2 < Corners.Num(); i += 3)
+		{
+			const FVector W0 = Transform.TransformPosition(FVector(Corners[i]));
+			const FVector W1 = Transform.TransformPosition(FVector(Corners[i + 1]));
+			const FVector W2 = Transform.TransformPosition(FVector(Corners[i + 2]));
+
+			// Entirely above the camera: cut, as by the rendered capture's near plane
+			if (W0.Z > Settings.CameraHeight && W1.Z > Settings.CameraHeight && W2.Z > Settings.CameraHeight) continue;
+
+			FPixelTriangle Triangle;
+			Triangle.P0 = FVector2f(Settings.WorldToPixel(FVector2D(W0)));
+			Triangle.P1 = FVector2f(Settings.WorldToPixel(FVector2D(W1)));
+			Triangle.P2 = FVector2f(Settings.WorldToPixel(FVector2D(W2)));
+
+			const float MinX = FMath::Min3(Triangle.P0.X, Triangle.P1.X, Triangle.P2.X);
+			const float MaxX = FMath::Max3(Triangle.P0.X, Triangle.P1.X, Triangle.P2.X);
+			const float MinY = FMath::Min3(Triangle.P0.Y, Triangle.P1.Y, Triangle.P2.Y);
+			const float MaxY = FMath::Max3(Triangle.P0.Y, Triangle.P1.Y, Triangle.P2.Y);
+			if (MaxX < 0.f || MaxY < 0.f || MinX > Settings.Width || MinY > Settings.Height) continue;
+
+			Triangle.Z0 = W0.Z;
+			Triangle.Z1 = W1.Z;
+			Triangle.Z2 = W2.Z;
+			Triangle.Flatness = FMath::Abs((float)FVector::CrossProduct(W1 - W0, W2 - W0).GetSafeNormal().Z);
+			Out.Add(Triangle);
+		}
+	}
+
+	FORCEINLINE float Edge(const FVector2f& A, const FVector2f& B, const FVector2f& P)
+	{
+		return (B.X - A.X) * (P.Y - A.Y) - (B.Y - A.Y) * (P.X - A.X);
+	}
+}
+
+// =============================================================================
+// Rasterisation
+// =============================================================================
+
+namespace
+{
+	struct FFloorPlan
+	{
+		FOrthoCaptureSettings Settings;
+		TArray<TSharedPtr<IOrthoRowSink>> Sinks;
+		TFunction<void(bool)> OnDone;
+
+		TArray<TArray<FVector3f>> Meshes;
+		TArray<FMeshInstance> Instances;
+
+		int32 TilesX = 0;
+		int32 TilesY = 0;
+		float MinZ = 0.f;
+		float MaxZ = 0.f;
+
+		void RasteriseTile(const TArray<FPixelTriangle>& Triangles, const TArray<int32>& Bin, int32 TileX, int32 TileY, TArray<FColor>& Band) const
+		{
+			const int32 X0 = TileX * FOrthoFloorPlanRasterizer::TileSize;
+			const int32 Y0 = TileY * FOrthoFloorPlanRasterizer::TileSize;
+			const int32 W = FMath::Min(FOrthoFloorPlanRasterizer::TileSize, Settings.Width - X0);
+			const int32 H = FMath::Min(FOrthoFloorPlanRasterizer::TileSize, Settings.Height - Y0);
+
+			TArray<float> Height;
+			TArray<float> Flatness;
+			Height.Init(-UE_BIG_NUMBER, W * H);
+			Flatness.SetNumZeroed(W * H);
+
+			for (const int32 Index : Bin)
+			{
+				const FPixelTriangle& T = Triangles[Index];
+				const float Area = Edge(T.P0, T.P1, T.P2);
+				if (FMath::Abs(Area) < UE_KINDA_SMALL_NUMBER) continue;
+				const float InvArea = 1.f / Area;
+
+				const int32 MinX = FMath::Max(X0, FMath::FloorToInt(FMath::Min3(T.P0.X, T.P1.X, T.P2.X)));
+				const int32 MaxX = FMath::Min(X0 + W - 1, FMath::CeilToInt(FMath::Max3(T.P0.X, T.P1.X, T.P2.X)));
+				const int32 MinY = FMath::Max(Y0, FMath::FloorToInt(FMath::Min3(T.P0.Y, T.P1.Y, T.P2.Y)));
+				const int32 MaxY = FMath::Min(Y0 + H - 1, FMath::CeilToInt(FMath::Max3(T.P0.Y, T.P1.Y, T.P2.Y)));
+
+				for (int32 Y = MinY; Y <= MaxY; ++Y)
+				{
+					for (int32 X = MinX; X <= MaxX; ++X)
+					{
+						// Pixel centres, either winding
+						const FVector2f P(X + 0.5f, Y + 0.5f);
+						const float B0 = Edge(T.P1, T.P2, P) * InvArea;
+						const float B1 = Edge(T.P2, T.P0, P) * InvArea;
+						const float B2 = 1.f - B0 - B1;
+						if (B0 < 0.f || B1 < 0.f || B2 < 0.f) continue;
+
+						const float Z = B0 * T.Z0 + B1 * T.Z1 + B2 * T.Z2;
+						const int32 Pixel = (Y - Y0) * W + (X - X0);
+						if (Z <= Settings.CameraHeight && Z > Height[Pixel])
+						{
+							Height[Pixel] = Z;
+							Flatness[Pixel] = T.Flatness;
+						}
+					}
+				}
+			}
+
+			// Brighter with height, darker on steep faces so walls outline the rooms
+			const float InvRange = MaxZ > MinZ ? 1.f / (MaxZ - MinZ) : 0.f;
+			for (int32 Y = 0; Y < H; ++Y)
+			{
+				FColor* Row = &Band[Y * Settings.Width + X0];
+				for (int32 X = 0; X < W; ++X)
+				{
+					const int32 Pixel = Y * W + X;
+					if (Height[Pixel] == -UE_BIG_NUMBER)
+					{
+						Row[X] = FColor::Black;
+						continue;
+					}
+					const float Relative = FMath::Clamp((Height[Pixel] - MinZ) * InvRange, 0.f, 1.f);
+					const float Value = (0.25f + 0.75f * Relative) * (0.55f + 0.45f * Flatness[Pixel]);
+					const uint8 Grey = (uint8)FMath::RoundToInt(255.f * Value);
+					Row[X] = FColor(Grey, Grey, Grey, 255);
+				}
+			}
+		}
+
+		bool Run()
+		{
+			// Project every instance in parallel, then bin by tile for the raster pass
+			TArray<TArray<FPixelTriangle>> Projected;
+			Projected.SetNum(Instances.Num());
+			ParallelFor(Instances.Num(), [this, &Projected](int32 Index)
+			{
+				ProjectInstance(Settings, Meshes[Instances[Index].Mesh], Instances[Index].Transform, Projected[Index]);
+			});
+			Meshes.Empty();
+
+			TArray<FPixelTriangle> Triangles;
+			for (TArray<FPixelTriangle>& Part : Projected) { Triangles.Append(MoveTemp(Part)); }
+			Projected.Empty();
+
+			MinZ = UE_BIG_NUMBER;
+			MaxZ = -UE_BIG_NUMBER;
+			TilesX = FMath::DivideAndRoundUp(Settings.Width, FOrthoFloorPlanRasterizer::TileSize);
+			TilesY = FMath::DivideAndRoundUp(Settings.Height, FOrthoFloorPlanRasterizer::TileSize);
+			TArray<TArray<int32>> Bins;
+			Bins.SetNum(TilesX * TilesY);
+			for (int32 Index = 0; Index < Triangles.Num(); ++Index)
+			{
+				const FPixelTriangle& T = Triangles[Index];
+				MinZ = FMath::Min(MinZ, FMath::Min3(T.Z0, T.Z1, T.Z2));
+				MaxZ = FMath::Max(MaxZ, FMath::Min(FMath::Max3(T.Z0, T.Z1, T.Z2), Settings.CameraHeight));
+
+				const int32 TX0 = FMath::Clamp(FMath::FloorToInt(FMath::Min3(T.P0.X, T.P1.X, T.P2.X)) / FOrthoFloorPlanRasterizer::TileSize, 0, TilesX - 1);
+				const int32 TX1 = FMath::Clamp(FMath::FloorToInt(FMath::Max3(T.P0.X, T.P1.X, T.P2.X)) / FOrthoFloorPlanRasterizer::TileSize, 0, TilesX - 1);
+				const int32 TY0 = FMath::Clamp(FMath::FloorToInt(FMath::Min3(T.P0.Y, T.P1.Y, T.P2.Y)) / FOrthoFloorPlanRasterizer::TileSize, 0, TilesY - 1);
+				const int32 TY1 = FMath::Clamp(FMath::FloorToInt(FMath::Max3(T.P0.Y, T.P1.Y, T.P2.Y)) / FOrthoFloorPlanRasterizer::TileSize, 0, TilesY - 1);
+				for (int32 TY = TY0; TY <= TY1; ++TY)
+				{
+					for (int32 TX = TX0; TX <= TX1; ++TX)
+					{
+						Bins[TY * TilesX + TX].Add(Index);
+					}
+				}
+			}
+
+			UE_LOG(LogOrthoCapture, Log, TEXT("OrthoCapture: rasterising %d triangles from %d mesh instances on the CPU"), Triangles.Num(), Instances.Num());
+
+			// One band of tile rows at a time keeps the output streaming like the rendered path
+			bool bSuccess = true;
+			TArray<FColor> Band;
+			for (int32 TileY = 0; TileY < TilesY && bSuccess; ++TileY)
+			{
+				const int32 FirstRow = TileY * FOrthoFloorPlanRasterizer::TileSize;
+				const int32 NumRows = FMath::Min(FOrthoFloorPlanRasterizer::TileSize, Settings.Height - FirstRow);
+				Band.SetNumUninitialized(Settings.Width * NumRows);
+
+				ParallelFor(TilesX, [this, &Triangles, &Bins, &Band, TileY](int32 TileX)
+				{
+					RasteriseTile(Triangles, Bins[TileY * TilesX + TileX], TileX, TileY, Band);
+				});
+
+				for (const TSharedPtr<IOrthoRowSink>& Sink : Sinks)
+				{
+					bSuccess &= Sink->AddRows(Band.GetData(), FirstRow, NumRows);
+				}
+			}
+
+			for (const TSharedPtr<IOrthoRowSink>& Sink : Sinks)
+			{
+				bSuccess &= Sink->Finish();
+			}
+			return bSuccess;
+		}
+	};
+}
+
+// =============================================================================
+// Entry point
+// =============================================================================
+
+void FOrthoFloorPlanRasterizer::Capture(UWorld* World, const FOrthoCaptureSettings& Settings, TArray<TSharedPtr<IOrthoRowSink>> Sinks, TFunction<void(bool)> OnDone)
+{
+	check(IsInGameThread());
+
+	TSharedRef<FFloorPlan> State = MakeShared<FFloorPlan>();
+	State->Settings = Settings;
+	State->Sinks = MoveTemp(Sinks);
+	State->OnDone = MoveTemp(OnDone);
+
+	if (!World)
+	{
+		State->OnDone(false);
+		return;
+	}
+
+	// Mesh descriptions may have to be loaded from bulk data, which is game thread work;
+	// the triangles are copied out so the workers never touch a UObject
+	TMap<UStaticMesh*, int32> MeshIndices;
+	int32 NumSkipped = 0;
+	for (ULevel* Level : World->GetLevels())
+	{
+		if (!Level || !Level->bIsVisible) continue;
+
+		for (AActor* Actor : Level->Actors)
+		{
+			if (!Actor || Actor->IsHidden()) continue;
+
+			TInlineComponentArray<UStaticMeshComponent*> Components(Actor);
+			for (UStaticMeshComponent* Component : Components)
+			{
+				UStaticMesh* Mesh = Component->GetStaticMesh();
+				if (!Mesh || !Component->IsVisible() || Component->bHiddenInGame) continue;
+
+				int32* MeshIndex = MeshIndices.Find(Mesh);
+				if (!MeshIndex)
+				{
+					const FMeshDescription* Description = Mesh->GetMeshDescription(0);
+					if (!Description)
+					{
+						++NumSkipped;
+						continue;
+					}
+					MeshIndex = &MeshIndices.Add(Mesh, State->Meshes.Add(ExtractTriangles(*Description)));
+				}
+
+				if (UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component))
+				{
+					for (int32 Instance = 0; Instance < Instanced->GetInstanceCount(); ++Instance)
+					{
+						FTransform Transform;
+						if (Instanced->GetInstanceTransform(Instance, Transform, true))
+						{
+							State->Instances.Add({ *MeshIndex, Transform });
+						}
+					}
+				}
+				else
+				{
+					State->Instances.Add({ *MeshIndex, Component->GetComponentTransform() });
+				}
+			}
+		}
+	}
+	if (NumSkipped > 0)
+	{
+		UE_LOG(LogOrthoCapture, Warning, TEXT("OrthoCapture: %d static mesh components without editor geometry were left out"), NumSkipped);
+	}
+
+	for (const TSharedPtr<IOrthoRowSink>& Sink : State->Sinks)
+	{
+		if (!Sink->Begin(Settings.Width, Settings.Height))
+		{
+			State->OnDone(false);
+			return;
+		}
+	}
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [State]()
+	{
+		const bool bSuccess = State->Run();
+		AsyncTask(ENamedThreads::GameThread, [State, bSuccess]() { State->OnDone(bSuccess); });
+	});
+}
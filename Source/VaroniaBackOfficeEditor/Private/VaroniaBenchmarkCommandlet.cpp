@@ -0,0 +1,335 @@
+// VaroniaBenchmarkCommandlet.cpp
+
+#include "VaroniaBenchmarkCommandlet.h"
+#include "VaroniaBackOfficeManager.h"
+#include "VaroniaBoundaryCrossings.h"
+#include "VaroniaMqttLibrary.h"
+#include "VaroniaPoseJitterBuffer.h"
+#include "VaroniaSpatialMath.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "HAL/FileManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVaroniaBenchmark, Log, All);
+
+// =============================================================================
+// Synthetic inputs
+// =============================================================================
+
+static TSharedRef<FJsonObject> MakeVector(double X, double Y, double Z)
+{
+	TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+	Object->SetNumberField(TEXT("x"), X);
+	Object->SetNumberField(TEXT("y"), Y);
+	Object->SetNumberField(TEXT("z"), Z);
+	return Object;
+}
+
+// NewSpatial.json in Unity coordinates: one main boundary plus NumBoundaries-1 sub-zones
+static FString MakeSpatialJson(int32 NumBoundaries, int32 PointsPerBoundary, int32 Seed)
+{
+	FRandomStream Random(Seed);
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("ID"), TEXT("Bench"));
+	Root->SetStringField(TEXT("Name"), TEXT("Benchmark Arena"));
+	Root->SetStringField(TEXT("AreaValue"), TEXT("400 sqm {20x20}"));
+	Root->SetStringField(TEXT("MaxRect"), TEXT("20x20"));
+	Root->SetStringField(TEXT("GroupName"), TEXT("Bench"));
+	Root->SetNumberField(TEXT("MaxPlayer"), 10);
+	Root->SetNumberField(TEXT("Multiplier"), 0.05);
+	Root->SetStringField(TEXT("OrthoKey"), TEXT("Bench_1"));
+	Root->SetObjectField(TEXT("SyncPos"), MakeVector(0, 0, 0));
+
+	TSharedRef<FJsonObject> Quat = MakeVector(0, 0, 0);
+	Quat->SetNumberField(TEXT("w"), 1);
+	Root->SetObjectField(TEXT("SyncQuaterion"), Quat);
+
+	TArray<TSharedPtr<FJsonValue>> Boundaries;
+	for (int32 b = 0; b < NumBoundaries; ++b)
+	{
+		const bool bMain = (b == 0);
+		const double Radius = bMain ? 10.0 : Random.FRandRange(0.5, 2.0);
+		const double CX = bMain ? 0.0 : Random.FRandRange(-6.0, 6.0);
+		const double CZ = bMain ? 0.0 : Random.FRandRange(-6.0, 6.0);
+
+		TArray<TSharedPtr<FJsonValue>> Points;
+		for (int32 p = 0; p < PointsPerBoundary; ++p)
+		{
+			const double Angle = 2.0 * PI * p / PointsPerBoundary;
+			const double R = Radius * Random.FRandRange(0.9, 1.0);
+			Points.Add(MakeShared<FJsonValueObject>(MakeVector(CX + R * FMath::Cos(Angle), 0.0, CZ + R * FMath::Sin(Angle))));
+		}
+
+		TSharedRef<FJsonObject> Boundary = MakeShared<FJsonObject>();
+		Boundary->SetStringField(TEXT("ID"), bMain ? FString(TEXT("BoundaryMain")) : FString::Printf(TEXT("Boundary%d"), b - 1));
+		Boundary->SetNumberField(TEXT("DisplayDistance"), 1.5);
+		Boundary->SetBoolField(TEXT("Reverse"), !bMain);
+		Boundary->SetBoolField(TEXT("BoundaryMoreVisible"), false);
+		Boundary->SetBoolField(TEXT("AlertLimit"), true);
+		Boundary->SetBoolField(TEXT("MainBoundary"), bMain);
+		Boundary->SetBoolField(TEXT("Visible"), true);
+		Boundary->SetObjectField(TEXT("BoundaryColor"), MakeVector(1, 0, 0));
+		Boundary->SetArrayField(TEXT("Points"), Points);
+		Boundaries.Add(MakeShared<FJsonValueObject>(Boundary));
+	}
+	Root->SetArrayField(TEXT("Boundaries"), Boundaries);
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	FJsonSerializer::Serialize(Root, Writer);
+	return Output;
+}
+
+// GlobalConfig.json: full, partial (defaults fill the rest) and malformed
+static FString MakeConfigJson(int32 Variant)
+{
+	switch (Variant)
+	{
+	case 0:
+		return TEXT("{\"ServerIP\":\"10.0.0.2\",\"MQTT_ServerIP\":\"10.0.0.2\",\"MQTT_IDClient\":12,\"DeviceMode\":3,\"Language\":\"En\",\"MainHand\":1,\"PlayerName\":\"Bench Player\"}");
+	case 1:
+		return TEXT("{\"MQTT_IDClient\":3,\"PlayerName\":\"Partial\"}");
+	default:
+		return TEXT("{\"ServerIP\":\"10.0.0.2\",");
+	}
+}
+
+// =============================================================================
+// Commandlet
+// =============================================================================
+
+UVaroniaBenchmarkCommandlet::UVaroniaBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+void UVaroniaBenchmarkCommandlet::Measure(const FString& Name, TMap<FString, int32> Params, TFunctionRef<void()> Body, TFunction<void()> Setup)
+{
+	const int32 WarmUp = FMath::Max(Iterations / 10, 1);
+	for (int32 i = 0; i < WarmUp; ++i)
+	{
+		if (Setup) { Setup(); }
+		Body();
+	}
+
+	FResult& Result = Results.AddDefaulted_GetRef();
+	Result.Name = Name;
+	Result.Params = MoveTemp(Params);
+	Result.SamplesUs.Reserve(Iterations);
+
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		if (Setup) { Setup(); }
+
+		const double Start = FPlatformTime::Seconds();
+		Body();
+		Result.SamplesUs.Add((FPlatformTime::Seconds() - Start) * 1e6);
+	}
+
+	Result.SamplesUs.Sort();
+	UE_LOG(LogVaroniaBenchmark, Display, TEXT("%-28s median %10.2f us"), *Name, Result.SamplesUs[Result.SamplesUs.Num() / 2]);
+}
+
+int32 UVaroniaBenchmarkCommandlet::Main(const FString& Params)
+{
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	Iterations = FMath::Max(Iterations, 1);
+
+	FString OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Varonia"), TEXT("Benchmark.json"));
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	const FString WorkDir = FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("VaroniaBenchmark"));
+	IFileManager::Get().MakeDirectory(*WorkDir, true);
+
+	// The loaders log every call; keep the output readable
+	if (GEngine)
+	{
+		GEngine->Exec(nullptr, TEXT("Log LogVaronia Warning"));
+	}
+
+	UVaroniaBackOfficeManager* Manager = NewObject<UVaroniaBackOfficeManager>();
+	Manager->AddToRoot();
+
+	// Results of the pure queries, so the compiler cannot drop them
+	double Checksum = 0.0;
+
+	// --- Spatial ---
+	const int32 QueryCount = 100;
+	const int32 BoundaryCounts[] = { 1, 8, 32 };
+	const int32 PointCounts[] = { 16, 256, 2048 };
+	for (int32 NumBoundaries : BoundaryCounts)
+	{
+		for (int32 NumPoints : PointCounts)
+		{
+			const FString Path = FPaths::Combine(WorkDir, FString::Printf(TEXT("NewSpatial_%d_%d.json"), NumBoundaries, NumPoints));
+			FFileHelper::SaveStringToFile(MakeSpatialJson(NumBoundaries, NumPoints, NumBoundaries * 7919 + NumPoints), *Path);
+
+			Measure(TEXT("LoadSpatialConfig"), { { TEXT("Boundaries"), NumBoundaries }, { TEXT("Points"), NumPoints } },
+				[Manager, &Path]() { Manager->LoadSpatialConfigFromFile(Path); });
+
+			// Queries against the layout just loaded, at points spread over the play area (Unreal cm)
+			const TArray<FSpatialBoundary>& Boundaries = Manager->SpatialConfig.Boundaries;
+			TArray<FBox2D> Bounds;
+			for (const FSpatialBoundary& Boundary : Boundaries) { Bounds.Add(VaroniaSpatial::GetBounds2D(Boundary.Points)); }
+
+			FRandomStream QueryRandom(NumBoundaries * 31 + NumPoints);
+			TArray<FVector2D> Queries;
+			TArray<FVector> Walk;
+			FVector WalkPosition = FVector::ZeroVector;
+			double Heading = 0.0;
+			for (int32 i = 0; i < QueryCount; ++i)
+			{
+				Queries.Add(FVector2D(QueryRandom.FRandRange(-1000.0, 1000.0), QueryRandom.FRandRange(-1000.0, 1000.0)));
+
+				// A player walking at 1.8 m/s sampled at 90 Hz, slowly turning
+				Heading += QueryRandom.FRandRange(-0.1, 0.1);
+				WalkPosition = (WalkPosition + 2.0 * FVector(FMath::Cos(Heading), FMath::Sin(Heading), 0.0)).BoundToCube(900.0);
+				Walk.Add(WalkPosition);
+			}
+			const TMap<FString, int32> QueryParams = { { TEXT("Boundaries"), NumBoundaries }, { TEXT("Points"), NumPoints }, { TEXT("Queries"), QueryCount } };
+
+			Measure(TEXT("PointInBoundaries"), QueryParams, [&Boundaries, &Bounds, &Queries, &Checksum]()
+			{
+				int32 Inside = 0;
+				for (const FVector2D& P : Queries)
+				{
+					for (int32 b = 0; b < Boundaries.Num(); ++b)
+					{
+						Inside += Bounds[b].IsInside(P) && VaroniaSpatial::IsInsidePolygon(Boundaries[b].Points, P);
+					}
+				}
+				Checksum += Inside;
+			});
+
+			// The boundary alert check: closest edge among the zones within display distance
+			Measure(TEXT("DistanceToBoundaryEdge"), QueryParams, [&Boundaries, &Bounds, &Queries, &Checksum]()
+			{
+				for (const FVector2D& P : Queries)
+				{
+					double Closest = TNumericLimits<double>::Max();
+					for (int32 b = 0; b < Boundaries.Num(); ++b)
+					{
+						if (Bounds[b].ExpandBy(150.0).IsInside(P))
+						{
+							Closest = FMath::Min(Closest, VaroniaSpatial::DistSquaredToPolygonEdge(Boundaries[b].Points, P));
+						}
+					}
+					Checksum += Closest < TNumericLimits<double>::Max() ? Closest : 0.0;
+				}
+			});
+
+			FVaroniaBoundaryCrossings Crossings;
+			Crossings.Build(Manager->SpatialConfig, 5.f);
+			TArray<FVaroniaBoundaryCrossing> Events;
+			double WalkTime = 0.0;
+			Measure(TEXT("BoundaryCrossings"), QueryParams, [&Crossings, &Walk, &WalkTime]()
+			{
+				for (const FVector& Location : Walk)
+				{
+					Crossings.AddPose(1, Location, WalkTime);
+					WalkTime += 1.0 / 90.0;
+				}
+			},
+			[&Crossings, &Events]() { Crossings.ConsumeEvents(Events); });
+		}
+	}
+
+	// --- Global config (variant 2 is malformed and exercises the default-file rewrite) ---
+	for (int32 Variant = 0; Variant < 3; ++Variant)
+	{
+		const FString Path = FPaths::Combine(WorkDir, FString::Printf(TEXT("GlobalConfig_%d.json"), Variant));
+		const FString Json = MakeConfigJson(Variant);
+		FFileHelper::SaveStringToFile(Json, *Path);
+
+		// The malformed file is replaced by defaults on load: put it back outside the timed body
+		TFunction<void()> Restore;
+		if (Variant == 2)
+		{
+			Restore = [&Path, &Json]() { FFileHelper::SaveStringToFile(Json, *Path); };
+		}
+		Measure(TEXT("LoadLBEConfig"), { { TEXT("Variant"), Variant } }, [Manager, &Path]() { Manager->LoadLBEConfigFromFile(Path); }, MoveTemp(Restore));
+	}
+
+	// --- MQTT payloads ---
+	Measure(TEXT("FormatMqttMessage"), { { TEXT("Items"), 0 } }, []() { UVaroniaMqttLibrary::FormatMqttMessage(12, TEXT("Heartbeat")); });
+	Measure(TEXT("FormatMqttMessage"), { { TEXT("Items"), 2 } }, []() { UVaroniaMqttLibrary::FormatMqttMessage(12, TEXT("Heartbeat"), 115, TEXT("Bench Player")); });
+
+	const int32 StreamLength = 1000;
+	TArray<FString> JsonStream;
+	TArray<TArray<uint8>> PoseStream;
+	FRandomStream Random(42);
+	for (int32 i = 0; i < StreamLength; ++i)
+	{
+		JsonStream.Add(UVaroniaMqttLibrary::FormatMqttMessage(i % 64, TEXT("Heartbeat"), 110 + (i % 3) * 5, TEXT("Bench Player")));
+
+		FVaroniaPoseMessage Pose;
+		Pose.DeviceID = i % 64;
+		Pose.Timestamp = i / 90.0;
+		Pose.Location = Random.VRand() * 500.0;
+		Pose.Encode(PoseStream.AddDefaulted_GetRef());
+	}
+
+	Measure(TEXT("ParseMqttMessage"), { { TEXT("Messages"), StreamLength } }, [&JsonStream]()
+	{
+		FVaroniaMqttPayload Payload;
+		for (const FString& Message : JsonStream) { UVaroniaMqttLibrary::ParseMqttMessage(Message, Payload); }
+	});
+	Measure(TEXT("DecodePoseMessage"), { { TEXT("Messages"), StreamLength } }, [&PoseStream]()
+	{
+		FVaroniaPoseMessage Pose;
+		for (const TArray<uint8>& Bytes : PoseStream) { FVaroniaPoseMessage::Decode(Bytes, Pose); }
+	});
+
+	Manager->RemoveFromRoot();
+	UE_LOG(LogVaroniaBenchmark, Verbose, TEXT("Query checksum %f"), Checksum);
+
+	if (!WriteResults(OutputPath))
+	{
+		UE_LOG(LogVaroniaBenchmark, Error, TEXT("Failed to write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogVaroniaBenchmark, Display, TEXT("%d benchmark cases written to %s"), Results.Num(), *OutputPath);
+	return 0;
+}
+
+bool UVaroniaBenchmarkCommandlet::WriteResults(const FString& OutputPath) const
+{
+	TArray<TSharedPtr<FJsonValue>> Cases;
+	for (const FResult& Result : Results)
+	{
+		const TArray<double>& S = Result.SamplesUs;
+		double Sum = 0.0;
+		for (double Sample : S) { Sum += Sample; }
+
+		TSharedRef<FJsonObject> Case = MakeShared<FJsonObject>();
+		Case->SetStringField(TEXT("Name"), Result.Name);
+
+		TSharedRef<FJsonObject> ParamsObject = MakeShared<FJsonObject>();
+		for (const TPair<FString, int32>& Param : Result.Params) { ParamsObject->SetNumberField(Param.Key, Param.Value); }
+		Case->SetObjectField(TEXT("Params"), ParamsObject);
+
+		Case->SetNumberField(TEXT("Iterations"), S.Num());
+		Case->SetNumberField(TEXT("MinUs"), S[0]);
+		Case->SetNumberField(TEXT("MedianUs"), S[S.Num() / 2]);
+		Case->SetNumberField(TEXT("P95Us"), S[FMath::Min(S.Num() - 1, (S.Num() * 95) / 100)]);
+		Case->SetNumberField(TEXT("MeanUs"), Sum / S.Num());
+		Cases.Add(MakeShared<FJsonValueObject>(Case));
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("Platform"), FPlatformProperties::IniPlatformName());
+	Root->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetArrayField(TEXT("Results"), Cases);
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	return FJsonSerializer::Serialize(Root, Writer) && FFileHelper::SaveStringToFile(Output, *OutputPath);
+}
@@ -4,6 +4,7 @@
 #include "CoreMinimal.h"
 #include "Widgets/SCompoundWidget.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
+#include "OrthoCaptureRenderer.h"
 
 class ACameraActor;
 
@@ -23,9 +24,19 @@ private:
 	// --- State ---
 	bool bIsSetupMode = false;
 	bool bIsCleanedUp = false;
+	bool bIsCapturing = false;
 	float OrthographicSize = 10.f;
 	float CameraHeight = 50.f;
 
+	/** Tiles per side: 1 = single 1920x1080 JPG, N = (1920 N)x(1080 N) PNG stitched from N x N renders */
+	int32 Tiles = 1;
+
+	/** Also write a deep-zoom tile pyramid (<Map>_<Size>_tiles/) for the back office web viewer */
+	bool bExportPyramid = false;
+
+	/** Draw the boundaries of the local NewSpatial.json over the image */
+	bool bOverlayBoundaries = false;
+
 	TWeakObjectPtr<ACameraActor> TempCamActor;
 
 	// --- UI builders ---
@@ -35,6 +46,7 @@ private:
 
 	// --- Actions ---
 	void OnStartSetup();
+	FOrthoCaptureSettings MakeSettings() const;
 	void UpdateCamera();
 	void CaptureAndExit();
 	void Cleanup();
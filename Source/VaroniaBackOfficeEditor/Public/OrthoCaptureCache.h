@@ -0,0 +1,45 @@
+// OrthoCaptureCache.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OrthoCaptureRenderer.h"
+
+class UWorld;
+
+/**
+ * Index of previous captures (<Dir>/CaptureCache.json) so unchanged maps are not rendered again.
+ *
+ * A capture is keyed by a hash of what can change its pixels: every actor's class and transform,
+ * its primitives' meshes and materials, lights, and the capture parameters. The MD5 of every level
+ * package and external actor package is folded in too, so instance, landscape, BSP and property edits
+ * count; contents rather than file times, so fresh checkouts still match.
+ */
+class FOrthoCaptureCache
+{
+public:
+	explicit FOrthoCaptureCache(const FString& InDirectory);
+
+	/** A missing or unreadable index is an empty cache */
+	void Load();
+	bool Save() const;
+
+	/** Options covers whatever else shapes the outputs (tile count, extra sinks...) */
+	static uint64 HashLevel(UWorld* World, const FOrthoCaptureSettings& Settings, const FString& Options);
+
+	/** Name was last captured with Hash and all of its outputs are still on disk */
+	bool IsUpToDate(const FString& Name, uint64 Hash) const;
+
+	void Record(const FString& Name, uint64 Hash, const FOrthoCaptureSettings& Settings, const TArray<FString>& Outputs);
+
+private:
+	struct FEntry
+	{
+		uint64 Hash = 0;
+		FOrthoCaptureSettings Settings;
+		TArray<FString> Outputs;
+		FDateTime Timestamp;
+	};
+
+	FString IndexPath;
+	TMap<FString, FEntry> Entries;
+};
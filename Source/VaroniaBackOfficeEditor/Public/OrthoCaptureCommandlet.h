@@ -0,0 +1,93 @@
+// OrthoCaptureCommandlet.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "OrthoCaptureCache.h"
+#include "OrthoCaptureRenderer.h"
+#include "OrthoCaptureCommandlet.generated.h"
+
+/**
+ * Unattended ortho captures for the nightly content build.
+ *
+ *   UnrealEditor-Cmd Project.uproject -run=OrthoCapture -AllowCommandletRendering -unattended
+ *       [-Maps=/Game/Maps/A+MapB] [-Spatial=<NewSpatial.json or folder>]
+ *       [-Output=Saved/Varonia/OrthoCaptures] [-Tiles=1] [-Pyramid] [-Margin=1.1] [-CameraHeight=50] [-Overlay] [-CPU] [-Force]
+ *       [-Upload=<broker>[:1883] [-UploadClientID=999] [-UploadTimeout=600]]
+ *
+ * -Maps are framed on their level bounds and named <Map>_<Size> like the editor tool.
+ * Each -Spatial layout is captured under its OrthoKey (<Map>_<Size>): with a size the framing is
+ * the one the editor tool would produce, without one it fits the main boundary.
+ * Every capture gets a <Name>.json georeferencing sidecar; -Overlay draws a layout's boundaries on it.
+ * -CPU, or running without a GPU (-nullrhi), switches to the rasterised floor plan backend.
+ * Captures whose level content hash matches CaptureCache.json are skipped unless -Force.
+ * Writes Summary.json next to the captures; returns non-zero if any capture failed.
+ * -Upload then sends every successful capture to the back office (FVaroniaMqttUploader); files it
+ * already holds are acknowledged at once, so up-to-date captures cost one round trip.
+ */
+UCLASS()
+class UOrthoCaptureCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UOrthoCaptureCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FJob
+	{
+		FString Name;
+		FString MapPath;
+
+		/** Spatial layout the job came from, empty for -Maps */
+		FString SpatialPath;
+		TArray<FSpatialBoundary> Boundaries;
+
+		/** Area to fit; invalid means the level bounds, zero size means keep OrthographicSize */
+		FBox2D Frame = FBox2D(ForceInit);
+		float OrthographicSize = 0.f;
+	};
+
+	struct FResult
+	{
+		FJob Job;
+		FOrthoCaptureSettings Settings;
+		FString Output;
+		FString Error;
+		bool bSuccess = false;
+		bool bSkipped = false;
+		uint64 Hash = 0;
+		double Seconds = 0.0;
+	};
+
+	FString OutputDir;
+	int32 Tiles = 1;
+	bool bPyramid = false;
+	float Margin = 1.1f;
+
+	/** Same default as the editor tool: ceilings above it stay out of the floor plan */
+	float CameraHeight = 50.f;
+
+	bool bOverlay = false;
+	bool bCpu = false;
+	bool bForce = false;
+	TUniquePtr<FOrthoCaptureCache> Cache;
+
+	void AddMapJobs(const FString& MapList, TArray<FJob>& OutJobs) const;
+	void AddSpatialJobs(const FString& Path, TArray<FJob>& OutJobs) const;
+
+	/** Long package name for a package path or a bare map name */
+	FString ResolveMap(const FString& Map) const;
+
+	UWorld* LoadWorld(const FString& MapPath) const;
+	void UnloadWorld(UWorld* World) const;
+
+	FResult Capture(UWorld* World, const FJob& Job);
+
+	bool WriteSummary(const TArray<FResult>& Results, double Seconds) const;
+
+	/** Number of files that could not be uploaded */
+	int32 Upload(const FString& Params, const TArray<FResult>& Results) const;
+};
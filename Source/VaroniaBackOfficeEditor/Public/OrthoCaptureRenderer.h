@@ -0,0 +1,69 @@
+// OrthoCaptureRenderer.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+class IOrthoRowSink;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogOrthoCapture, Log, All);
+
+/**
+ * Framing shared by the viewport preview and the offscreen capture.
+ */
+struct FOrthoCaptureSettings
+{
+	/** Unity-style ortho size; the ortho width in cm is OrthographicSize * 355 */
+	float OrthographicSize = 10.f;
+	float CameraHeight = 50.f;
+	FVector2D Center = FVector2D::ZeroVector;
+	int32 Width = 1920;
+	int32 Height = 1080;
+
+	float GetOrthoWidth() const { return OrthographicSize * 355.f; }
+	float GetCmPerPixel() const { return GetOrthoWidth() / Width; }
+	FVector GetCameraLocation() const { return FVector(Center.X, Center.Y, CameraHeight); }
+
+	/** Image pixel (x right, y down, pixel centres at .5) to world XY */
+	FVector2D PixelToWorld(const FVector2D& Pixel) const
+	{
+		return FVector2D(Center.X - (Pixel.X - Width * 0.5) * GetCmPerPixel(), Center.Y - (Pixel.Y - Height * 0.5) * GetCmPerPixel());
+	}
+
+	FVector2D WorldToPixel(const FVector2D& World) const
+	{
+		return FVector2D((Center.X - World.X) / GetCmPerPixel() + Width * 0.5, (Center.Y - World.Y) / GetCmPerPixel() + Height * 0.5);
+	}
+
+	/** Looking down, image right = world -X, image up = world +Y */
+	static FRotator GetCameraRotation() { return FRotator(-90.f, 90.f, 0.f); }
+};
+
+/**
+ * Renders an ortho view into a private render target and reads it back without stalling the
+ * game thread: scene capture, GPU copy, readback polled from the core ticker. The level viewport
+ * is never involved, so the result does not depend on the editor layout or window focus.
+ */
+class FOrthoCaptureRenderer
+{
+public:
+	/** bSuccess, then Width * Height pixels, top row first, alpha forced to 255 */
+	using FOnPixels = TFunction<void(bool, TArray<FColor>&&)>;
+
+	/** OnPixels runs on the game thread */
+	static void CapturePixels(UWorld* World, const FOrthoCaptureSettings& Settings, FOnPixels OnPixels);
+
+	/** Capture and write a JPG (or PNG, by extension) encoded on a worker; OnDone runs on the game thread once the file is on disk */
+	static void CaptureToFile(UWorld* World, const FOrthoCaptureSettings& Settings, const FString& Path, TFunction<void(bool)> OnDone);
+
+	/**
+	 * Capture Settings.Width x Settings.Height (multiples of the tile counts) as TilesX x TilesY renders
+	 * taken one after another. Each finished band of tiles is streamed to the sinks on a worker while
+	 * the next band renders, so peak memory is two bands whatever the output size.
+	 */
+	static void CaptureTiled(UWorld* World, const FOrthoCaptureSettings& Settings, int32 TilesX, int32 TilesY,
+		TArray<TSharedPtr<IOrthoRowSink>> Sinks, TFunction<void(bool)> OnDone);
+
+	/** Seconds a capture may wait for the GPU before it is reported as failed */
+	static constexpr double ReadbackTimeout = 10.0;
+};
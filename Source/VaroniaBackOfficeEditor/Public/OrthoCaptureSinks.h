@@ -0,0 +1,190 @@
+// OrthoCaptureSinks.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LBE_Types.h"
+#include "OrthoCaptureRenderer.h"
+#include "Tasks/Task.h"
+
+class IImageWrapperModule;
+
+/**
+ * Consumer of a capture delivered top to bottom in bands of full-width rows, so outputs far larger
+ * than memory allows can be produced. Calls come from one worker at a time, in row order.
+ */
+class IOrthoRowSink
+{
+public:
+	virtual ~IOrthoRowSink() = default;
+
+	virtual bool Begin(int32 Width, int32 Height) = 0;
+
+	/** NumRows rows of Width pixels starting at image row FirstRow */
+	virtual bool AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows) = 0;
+
+	virtual bool Finish() = 0;
+};
+
+/**
+ * RGB PNG written as rows arrive: each row is Sub-filtered and deflated straight into IDAT chunks,
+ * so memory stays at the zlib window plus one chunk whatever the image size.
+ */
+class FOrthoStreamingPngWriter : public IOrthoRowSink
+{
+public:
+	explicit FOrthoStreamingPngWriter(const FString& InPath);
+	virtual ~FOrthoStreamingPngWriter() override;
+
+	virtual bool Begin(int32 InWidth, int32 InHeight) override;
+	virtual bool AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows) override;
+	virtual bool Finish() override;
+
+private:
+	static constexpr int32 ChunkSize = 256 * 1024;
+
+	FString Path;
+	TUniquePtr<FArchive> File;
+	struct FDeflateState;
+	TUniquePtr<FDeflateState> Deflate;
+	TArray<uint8> Row;
+	TArray<uint8> Chunk;
+	int32 Width = 0;
+	int32 Height = 0;
+
+	bool Compress(const uint8* Data, int32 Size, bool bFinish);
+	void WriteChunk(const char* Type, const uint8* Data, int32 Size);
+};
+
+/**
+ * Whole image kept in memory and encoded at Finish with IImageWrapper; JPG or PNG by extension.
+ * For single-tile captures, where the image fits in memory anyway.
+ */
+class FOrthoImageFileWriter : public IOrthoRowSink
+{
+public:
+	explicit FOrthoImageFileWriter(const FString& InPath);
+
+	virtual bool Begin(int32 InWidth, int32 InHeight) override;
+	virtual bool AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows) override;
+	virtual bool Finish() override;
+
+private:
+	FString Path;
+	IImageWrapperModule* ImageWrapperModule = nullptr;
+	TArray<FColor> Pixels;
+	int32 Width = 0;
+	int32 Height = 0;
+};
+
+/**
+ * Deep-zoom pyramid for the back office web viewer: <Dir>/<Level>/<Column>_<Row>.jpg plus
+ * <Dir>/manifest.json. Level 0 is full resolution, each further level halves it (2x2 box filter)
+ * until the image fits in one tile.
+ *
+ * Every level keeps one band of TileSize rows; a full band is cut into tiles that are encoded in
+ * parallel on workers. At most MaxEncodesInFlight tiles wait for a worker (the capture blocks on
+ * the oldest beyond that), so memory stays bounded like the streaming PNG.
+ */
+class FOrthoTilePyramidWriter : public IOrthoRowSink
+{
+public:
+	FOrthoTilePyramidWriter(const FString& InDirectory, const FOrthoCaptureSettings& InSettings, int32 InTileSize = 256, int32 InQuality = 85);
+
+	virtual bool Begin(int32 InWidth, int32 InHeight) override;
+	virtual bool AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows) override;
+	virtual bool Finish() override;
+
+private:
+	struct FLevel
+	{
+		int32 Width = 0;
+		int32 Height = 0;
+
+		/** Rows [BandFirstRow, BandFirstRow + BandRows) not cut into tiles yet */
+		TArray<FColor> Band;
+		int32 BandFirstRow = 0;
+		int32 BandRows = 0;
+
+		/** Even row waiting for its odd partner before going down a level */
+		TArray<FColor> PendingRow;
+		bool bHasPendingRow = false;
+	};
+
+	FString Directory;
+	FOrthoCaptureSettings Settings;
+	int32 TileSize;
+	int32 Quality;
+	IImageWrapperModule* ImageWrapperModule = nullptr;
+	TArray<FLevel> Levels;
+	TArray<UE::Tasks::FTask> Encodes;
+	int32 MaxEncodesInFlight;
+	std::atomic<bool> bFailed { false };
+
+	void AddRow(int32 LevelIndex, const FColor* Row);
+	void Downsample(int32 LevelIndex, const FColor* RowA, const FColor* RowB);
+	void FlushBand(int32 LevelIndex);
+	bool WriteManifest() const;
+};
+
+/**
+ * Georeferencing sidecar for the back office: writes <Path> (JSON) at Finish with the framing and
+ * the pixel <-> world affine transforms, in Unreal cm and in NewSpatial.json (Unity metres) coordinates.
+ * Ignores the pixels.
+ */
+class FOrthoSidecarWriter : public IOrthoRowSink
+{
+public:
+	FOrthoSidecarWriter(const FString& InPath, const FOrthoCaptureSettings& InSettings, const FString& InImage);
+
+	virtual bool Begin(int32 InWidth, int32 InHeight) override { return true; }
+	virtual bool AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows) override { return true; }
+	virtual bool Finish() override;
+
+private:
+	FString Path;
+	FOrthoCaptureSettings Settings;
+	FString Image;
+};
+
+/**
+ * Draws the spatial boundaries over the capture, anti-aliased on the CPU, and passes the result to
+ * Inner. Each band is split into strips of rows drawn in parallel; a strip only visits the segments
+ * crossing it, and keeps the strongest coverage per boundary so joints are not blended twice.
+ */
+class FOrthoBoundaryOverlay : public IOrthoRowSink
+{
+public:
+	FOrthoBoundaryOverlay(const FOrthoCaptureSettings& InSettings, const TArray<FSpatialBoundary>& Boundaries,
+		TArray<TSharedPtr<IOrthoRowSink>> InInner, float InLineWidth = 3.f);
+
+	virtual bool Begin(int32 InWidth, int32 InHeight) override;
+	virtual bool AddRows(const FColor* Rows, int32 FirstRow, int32 NumRows) override;
+	virtual bool Finish() override;
+
+private:
+	struct FSegment
+	{
+		FVector2D A;
+		FVector2D B;
+		float MinY;
+		float MaxY;
+	};
+
+	struct FPolyline
+	{
+		FColor Color;
+		TArray<FSegment> Segments;
+	};
+
+	static constexpr int32 StripRows = 64;
+
+	FOrthoCaptureSettings Settings;
+	TArray<FSpatialBoundary> Source;
+	TArray<TSharedPtr<IOrthoRowSink>> Inner;
+	float LineWidth;
+	TArray<FPolyline> Polylines;
+	TArray<FColor> Band;
+	int32 Width = 0;
+
+	void DrawStrip(FColor* Rows, int32 FirstRow, int32 NumRows) const;
+};
@@ -0,0 +1,25 @@
+// OrthoFloorPlan.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OrthoCaptureRenderer.h"
+
+class UWorld;
+class IOrthoRowSink;
+
+/**
+ * GPU-free alternative to FOrthoCaptureRenderer for build agents without a graphics device.
+ *
+ * Static mesh triangles (editor mesh descriptions, instances included) are projected with the
+ * capture framing and rasterised into a top-down height buffer, one 256px tile per worker.
+ * Geometry above the camera is cut like the near plane of the rendered capture. The image is a
+ * grey shaded height map, black where nothing was hit, streamed to the same sinks band by band.
+ */
+class FOrthoFloorPlanRasterizer
+{
+public:
+	/** Same contract as FOrthoCaptureRenderer::CaptureTiled; OnDone runs on the game thread */
+	static void Capture(UWorld* World, const FOrthoCaptureSettings& Settings, TArray<TSharedPtr<IOrthoRowSink>> Sinks, TFunction<void(bool)> OnDone);
+
+	static constexpr int32 TileSize = 256;
+};
@@ -0,0 +1,41 @@
+// VaroniaBenchmarkCommandlet.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "VaroniaBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark of the plugin's hot paths on synthetic data.
+ *
+ *   UnrealEditor-Cmd Project.uproject -run=VaroniaBenchmark -nullrhi -unattended
+ *       [-Iterations=200] [-Output=Saved/Varonia/Benchmark.json]
+ *
+ * Writes one JSON result per case (min / median / p95 / mean in microseconds).
+ */
+UCLASS()
+class UVaroniaBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UVaroniaBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FResult
+	{
+		FString Name;
+		TMap<FString, int32> Params;
+		TArray<double> SamplesUs;
+	};
+
+	TArray<FResult> Results;
+	int32 Iterations = 200;
+
+	/** Runs Body Iterations times (after a short warm-up) and records the timings; Setup runs untimed before each run */
+	void Measure(const FString& Name, TMap<FString, int32> Params, TFunctionRef<void()> Body, TFunction<void()> Setup = nullptr);
+
+	bool WriteResults(const FString& OutputPath) const;
+};
@@ -20,9 +20,16 @@ public class VaroniaBackOfficeEditor : ModuleRules
             "UnrealEd",
             "LevelEditor",
             "ToolMenus",
+            "AssetRegistry",
             "RenderCore",
             "RHI",
             "ImageWrapper",
+            "MeshDescription",
+            "StaticMeshDescription",
+            "Json",
+            "VaroniaBackOffice",
         });
+
+        AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
     }
 }
\ No newline at end of file